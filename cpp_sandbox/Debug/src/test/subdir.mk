@@ -4,13 +4,25 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
-../src/test/results.cpp 
+../src/test/bench.cpp \
+../src/test/metrics.cpp \
+../src/test/reporter.cpp \
+../src/test/results.cpp \
+../src/test/runner.cpp 
 
 OBJS += \
-./src/test/results.o 
+./src/test/bench.o \
+./src/test/metrics.o \
+./src/test/reporter.o \
+./src/test/results.o \
+./src/test/runner.o 
 
 CPP_DEPS += \
-./src/test/results.d 
+./src/test/bench.d \
+./src/test/metrics.d \
+./src/test/reporter.d \
+./src/test/results.d \
+./src/test/runner.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -4,16 +4,43 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../src/util/alloc_tracker.cpp \
+../src/util/format.cpp \
+../src/util/interned_string.cpp \
+../src/util/message_queue.cpp \
+../src/util/number_format.cpp \
 ../src/util/pending_queue.cpp \
-../src/util/string.cpp 
+../src/util/recycle_pool.cpp \
+../src/util/rope.cpp \
+../src/util/slot_queue.cpp \
+../src/util/string.cpp \
+../src/util/trace.cpp 
 
 OBJS += \
+./src/util/alloc_tracker.o \
+./src/util/format.o \
+./src/util/interned_string.o \
+./src/util/message_queue.o \
+./src/util/number_format.o \
 ./src/util/pending_queue.o \
-./src/util/string.o 
+./src/util/recycle_pool.o \
+./src/util/rope.o \
+./src/util/slot_queue.o \
+./src/util/string.o \
+./src/util/trace.o 
 
 CPP_DEPS += \
+./src/util/alloc_tracker.d \
+./src/util/format.d \
+./src/util/interned_string.d \
+./src/util/message_queue.d \
+./src/util/number_format.d \
 ./src/util/pending_queue.d \
-./src/util/string.d 
+./src/util/recycle_pool.d \
+./src/util/rope.d \
+./src/util/slot_queue.d \
+./src/util/string.d \
+./src/util/trace.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
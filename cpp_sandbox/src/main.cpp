@@ -1,13 +1,197 @@
+// std::strcmp(), std::strlen(), std::strncmp()
+#include <cstring>
 
-// std::cout, std::endl
+// std::strtod(), std::strtoul()
+#include <cstdlib>
+
+// std::exception
+#include <exception>
+
+// std::cerr, std::endl
 #include <iostream>
 
+// std::string
+#include <string>
+
+// open(), O_WRONLY, O_CREAT, O_TRUNC
+#include <fcntl.h>
+
+// close(), STDOUT_FILENO
+#include <unistd.h>
+
 // mdt::test::output_all()
 #include "test/run_tests.hpp"
 
-auto main() -> int
+// mdt::bench::run_all()
+#include "test/bench.hpp"
+
+// mdt::test::make_reporter()
+#include "test/reporter.hpp"
+
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+// if argv[i] is the option 'name' followed by a value (as separate arguments, or joined directly for short options and by '=' for long options),
+// return the value and leave 'i' at its last argument; otherwise return nullptr
+static auto option_value(int argc, char **argv, int &i, char const *name) -> char const *
 {
+   std::size_t const length = std::strlen(name);
+   bool const is_long = name[1] == '-';
+
+   if(!std::strcmp(argv[i], name))
+   {
+      return i + 1 < argc ? argv[++i] : nullptr;
+   }
+
+   if(!std::strncmp(argv[i], name, length) && argv[i][length] && (!is_long || argv[i][length] == '='))
+   {
+      return argv[i] + length + is_long;
+   }
+
+   return nullptr;
+}
+#endif
+
+auto main(int argc, char **argv) -> int
+{
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+   // number of test groups run concurrently (-j N or -jN); benchmarks always run one at a time, so that they do not disturb each other
+   std::size_t jobs = 1;
+   bool jobs_given = false;
+
 #ifdef MDT_SELF_TEST
-   std::cout << mdt::test::run_all().to_string() << std::endl;
+   // run the benchmarks (--bench) instead of the self-tests
+   bool bench = false;
+#else
+   // without self-tests, only the benchmarks can be run
+   bool bench = true;
+#endif
+
+   // baseline to compare the benchmarks with (--baseline FILE) and file to save their medians to (--save-baseline FILE)
+   std::string baseline_path;
+   std::string save_path;
+
+   // benchmark measurement settings, including the regression threshold (--threshold PERCENT)
+   mdt::bench::settings settings;
+
+   // report format (--format text|jsonl|junit) and file (--output FILE; standard output by default)
+   std::string format = "text";
+   std::string output_path;
+
+   for(int i = 1; i < argc; ++i)
+   {
+      char const *value = nullptr;
+      char *end = nullptr;
+      bool valid = true;
+
+      if((value = option_value(argc, argv, i, "-j")))
+      {
+         valid = (jobs = std::strtoul(value, &end, 10)) && !*end;
+         jobs_given = true;
+      }
+      else if(!std::strcmp(argv[i], "--bench"))
+      {
+         bench = true;
+      }
+      else if((value = option_value(argc, argv, i, "--baseline")))
+      {
+         baseline_path = value;
+      }
+      else if((value = option_value(argc, argv, i, "--save-baseline")))
+      {
+         save_path = value;
+      }
+      else if((value = option_value(argc, argv, i, "--threshold")))
+      {
+         settings.threshold = std::strtod(value, &end) / 100;
+         valid = end != value && !*end && settings.threshold >= 0;
+      }
+      else if((value = option_value(argc, argv, i, "--format")))
+      {
+         format = value;
+         valid = !!mdt::test::make_reporter(format, STDOUT_FILENO);
+      }
+      else if((value = option_value(argc, argv, i, "--output")))
+      {
+         output_path = value;
+      }
+      else
+      {
+         valid = false;
+      }
+
+      // -j is rejected with --bench (even when it comes first) rather than silently ignored
+      if(!valid || (bench && jobs_given))
+      {
+         std::cerr << "usage: " << argv[0] << " [-j N] [--format text|jsonl|junit] [--output FILE]\n"
+                      "       " << argv[0] << " --bench [--baseline FILE] [--save-baseline FILE] [--threshold PERCENT] [--format text|jsonl|junit]"
+                      " [--output FILE]\n"
+                      "exits with 1 if a test fails or a benchmark is slower than its baseline by more than the threshold (10% by default);"
+                      " -j does not apply to --bench" << std::endl;
+         return 2;
+      }
+   }
+
+   // set once the run has been reported; the exit status is 1 if it failed
+   bool success = false;
+
+   int const fd = output_path.empty() ? STDOUT_FILENO : ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+   if(fd < 0)
+   {
+      std::cerr << argv[0] << ": unable to write the report file " << output_path << std::endl;
+      return 2;
+   }
+
+   try
+   {
+      // stream each group (or benchmark case) out as soon as it and those before it have completed
+      auto const report = mdt::test::make_reporter(format, fd);
+      auto const on_complete = [&report](mdt::test::result const &group){ report->group(group); };
+
+      // read the baseline before anything is reported
+      mdt::bench::baseline const reference = baseline_path.empty() ? mdt::bench::baseline{} : mdt::bench::load_baseline(baseline_path);
+
+      report->begin();
+
+      if(bench)
+      {
+         mdt::bench::baseline measured;
+         mdt::test::result const run = mdt::bench::run_all(settings, reference, measured, on_complete);
+
+         report->end(run.get_description(), run.is_success(), run.get_metrics());
+         success = run.is_success();
+
+         if(!save_path.empty())
+         {
+            mdt::bench::save_baseline(save_path, measured);
+         }
+      }
+#ifdef MDT_SELF_TEST
+      else
+      {
+         mdt::test::result const run = mdt::test::run_all(jobs, on_complete);
+
+         report->end(run.get_description(), run.is_success(), run.get_metrics());
+         success = run.is_success();
+      }
+#endif
+   }
+   catch(std::exception const &e)
+   {
+      std::cerr << argv[0] << ": " << e.what() << std::endl;
+      return 2;
+   }
+
+   if(fd != STDOUT_FILENO)
+   {
+      ::close(fd);
+   }
+
+   return success ? 0 : 1;
+#else
+   // options only apply to the self-tests and benchmarks
+   static_cast<void>(argc);
+   static_cast<void>(argv);
+
+   return 0;
 #endif
 }
@@ -0,0 +1,311 @@
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+
+// std::max(), std::min(), std::sort()
+#include <algorithm>
+
+// std::chrono::steady_clock
+#include <chrono>
+
+// std::ceil(), std::sqrt()
+#include <cmath>
+
+// std::strtod()
+#include <cstdlib>
+
+// std::ifstream, std::ofstream
+#include <fstream>
+
+// std::runtime_error
+#include <stdexcept>
+
+// mdt::bench::suite
+#include "bench.hpp"
+
+// mdt::pending_queue benchmark cases
+#include "../util/pending_queue.hpp"
+
+// string helper functions and benchmark cases
+#include "../util/string.hpp"
+
+namespace mdt { namespace bench
+{
+   // return the number of seconds taken to run 'iterations' iterations of the case
+   static auto time(suite::case_type const &body, std::size_t iterations) -> double
+   {
+      auto const start = std::chrono::steady_clock::now();
+
+      body(iterations);
+
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   }
+
+   auto load_baseline(std::string const &path) -> baseline
+   {
+      std::ifstream file{path};
+
+      if(!file)
+      {
+         throw std::runtime_error{std::string("unable to read the baseline file ") << path};
+      }
+
+      baseline medians;
+      std::string line;
+
+      while(std::getline(file, line))
+      {
+         // the median follows the last tab; lines without one (e.g., empty lines) are ignored
+         auto const tab = line.rfind('\t');
+
+         if(tab != std::string::npos)
+         {
+            medians[line.substr(0, tab)] = std::strtod(line.c_str() + tab + 1, nullptr);
+         }
+      }
+
+      return medians;
+   }
+
+   void save_baseline(std::string const &path, baseline const &medians)
+   {
+      std::string text;
+
+      for(auto const &entry : medians)
+      {
+         // shortest round-trip notation, so a saved baseline reads back exactly
+         text << entry.first << '\t' << entry.second << '\n';
+      }
+
+      std::ofstream file{path};
+
+      if(!(file << text) || !file.flush())
+      {
+         throw std::runtime_error{std::string("unable to write the baseline file ") << path};
+      }
+   }
+
+   void suite::add(std::string name, case_type body)
+   {
+      cases.emplace_back(std::move(name), std::move(body));
+   }
+
+   auto measure(suite::case_type const &body, settings const &config) -> statistics
+   {
+      // calibrate: grow the iteration count (by 2x to 10x at a time, aiming 20% past the target) until one sample is long enough
+      std::size_t iterations = 1;
+
+      for(double seconds = time(body, iterations); seconds < config.sample_seconds; seconds = time(body, iterations))
+      {
+         double const current = static_cast<double>(iterations);
+         double const estimate = current * config.sample_seconds * 1.2 / std::max(seconds, 1e-9);
+
+         iterations = static_cast<std::size_t>(std::min(std::max(estimate, current * 2), current * 10));
+      }
+
+      // warm up caches, branch predictors and CPU frequency before any sample is kept
+      for(double warm = 0; warm < config.warmup_seconds;)
+      {
+         warm += time(body, iterations);
+      }
+
+      std::vector<double> samples;
+      samples.reserve(config.samples);
+
+      for(std::size_t i = 0; i < std::max<std::size_t>(config.samples, 1); ++i)
+      {
+         samples.push_back(time(body, iterations) * 1e9 / static_cast<double>(iterations));
+      }
+
+      std::sort(samples.begin(), samples.end());
+
+      std::size_t const n = samples.size();
+
+      double sum = 0;
+
+      for(double sample : samples) sum += sample;
+
+      double const mean = sum / static_cast<double>(n);
+
+      double squares = 0;
+
+      for(double sample : samples) squares += (sample - mean) * (sample - mean);
+
+      return
+      {
+         samples.front(),
+         n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2,
+         samples[static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(n))) - 1],
+         mean,
+         n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0,
+         iterations,
+         n
+      };
+   }
+
+   auto suite::run(std::string description, settings const &config, baseline const &reference, baseline &measured,
+                   completion_type on_complete) const -> test::result
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
+
+      test::result results{std::move(description)};
+
+      // the status of the cases which have been passed to 'on_complete' (and not kept)
+      bool passed = true;
+
+      for(auto const &c : cases)
+      {
+         statistics const s = measure(c.second, config);
+
+         measured[c.first] = s.median;
+
+         std::string line;
+
+         line << c.first << ": median " << mdt::fixed(s.median, 1) << " ns (min " << mdt::fixed(s.min, 1) << (s.samples < 100 ? ", max " : ", p99 ")
+              << mdt::fixed(s.p99, 1) << ", stddev " << mdt::fixed(s.stddev, 1) << "; " << s.iterations << " iterations x " << s.samples << " samples)";
+
+         bool success = true;
+         auto const found = reference.find(c.first);
+
+         // compare with the baseline, if it has this case
+         if(found != reference.end())
+         {
+            double const change = s.median / found->second - 1;
+
+            success = !(change > config.threshold);
+
+            line << ", baseline " << mdt::fixed(found->second, 1) << " ns (" << (change < 0 ? "" : "+") << mdt::fixed(change * 100, 1) << "%)";
+         }
+
+         test::result measured_case{std::move(line), success};
+
+         // a reported case is not kept, so the returned result only holds the overall status
+         if(on_complete)
+         {
+            on_complete(measured_case);
+            passed = passed && success;
+         }
+         else
+         {
+            results << std::move(measured_case);
+         }
+      }
+
+      return on_complete ? test::result{results.get_description(), passed} : std::move(results);
+   }
+
+   auto run_all(settings const &config, baseline const &reference, baseline &measured, suite::completion_type on_complete) -> test::result
+   {
+      // register every mdt namespace utility benchmark, in the order in which the results are reported
+      suite cases;
+
+      bench::pending_queue::add_cases(cases);
+      bench::string::add_cases(cases);
+
+      // measure all mdt namespace utilities and return the results
+      return cases.run("mdt utility benchmarks", config, reference, measured, std::move(on_complete));
+   }
+}}
+
+#endif
+
+#ifdef MDT_SELF_TEST
+
+// std::remove()
+#include <cstdio>
+
+// mkstemp(), close()
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace mdt { namespace test { namespace bench
+{
+   auto all() -> result
+   {
+      test::result result{"bench tests"};
+
+      // keep the self-tests quick; the timings themselves are not checked
+      mdt::bench::settings config;
+      config.sample_seconds = 0.001;
+      config.samples = 5;
+      config.warmup_seconds = 0.001;
+
+      mdt::bench::suite cases;
+
+      cases.add("sum", [](std::size_t iterations)
+      {
+         std::size_t sum = 0;
+
+         for(std::size_t i = 0; i < iterations; ++i)
+         {
+            mdt::bench::keep(sum += i);
+         }
+      });
+
+      /**
+       * (1) Ensure that calibration finds an iteration count and that the statistics are ordered.
+       */
+      {
+         auto const s = mdt::bench::measure([](std::size_t iterations){ for(std::size_t i = 0; i < iterations; ++i) mdt::bench::keep(i); }, config);
+
+         result << test::result
+         {
+            "measure() statistics are consistent",
+            s.iterations > 1 && s.samples == 5 && s.min <= s.median && s.median <= s.p99 && s.min <= s.mean && s.mean <= s.p99 && s.stddev >= 0
+         };
+      }
+
+      /**
+       * (2) Ensure that a case slower than its baseline by more than the threshold fails, and that other cases succeed.
+       */
+      {
+         mdt::bench::baseline measured;
+
+         auto const slower = cases.run("slower", config, {{"sum", 1e-9}}, measured);
+         auto const faster = cases.run("faster", config, {{"sum", 1e9}}, measured);
+         auto const missing = cases.run("missing", config, {{"other", 1e-9}}, measured);
+
+         result << test::result{"slower than baseline -> failure", !slower.is_success() && slower.to_string().find("[FAILURE] .. sum: median") != std::string::npos};
+         result << test::result{"faster than baseline -> success", faster.is_success()};
+         result << test::result{"not in baseline -> success", missing.is_success() && measured.size() == 1 && measured.count("sum")};
+      }
+
+      /**
+       * (3) Ensure that a saved baseline reads back exactly.
+       */
+      {
+         char path[] = "/tmp/mdt-baseline-XXXXXX";
+         int const fd = mkstemp(path);
+
+         mdt::bench::baseline const saved{{"pending_queue add", 81.25}, {"concat", 1.0 / 3}};
+
+         bool same = false;
+
+         if(fd >= 0)
+         {
+            close(fd);
+            mdt::bench::save_baseline(path, saved);
+            same = mdt::bench::load_baseline(path) == saved;
+            std::remove(path);
+         }
+
+         result << test::result{"baseline save -> load round trip", same};
+
+         bool thrown = false;
+
+         try
+         {
+            mdt::bench::load_baseline("/nonexistent/mdt-baseline");
+         }
+         catch(std::runtime_error const &)
+         {
+            thrown = true;
+         }
+
+         result << test::result{"missing baseline file -> exception", thrown};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
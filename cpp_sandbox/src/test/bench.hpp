@@ -0,0 +1,122 @@
+#ifndef BENCH_HPP_
+#define BENCH_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::function
+#include <functional>
+
+// std::map
+#include <map>
+
+// std::string
+#include <string>
+
+// std::pair
+#include <utility>
+
+// std::vector
+#include <vector>
+
+// mdt::test::result
+#include "results.hpp"
+
+namespace mdt { namespace bench
+{
+   // keep the compiler from optimizing away the computation of 'value' (or moving it out of the timed loop)
+   template<typename T>
+   inline void keep(T const &value)
+   {
+      asm volatile("" : : "r"(&value) : "memory");
+   }
+
+   /**
+    * Timings of a benchmark case, in nanoseconds per iteration.
+    */
+   struct statistics
+   {
+      // fastest, median and 99th-percentile (nearest-rank) sample; with fewer than 100 samples, the nearest-rank 99th percentile is simply the
+      // slowest sample, so it is reported as the maximum instead
+      double min;
+      double median;
+      double p99;
+
+      // mean and (sample) standard deviation of every sample
+      double mean;
+      double stddev;
+
+      // iterations run per sample, as found by calibration, and number of samples
+      std::size_t iterations;
+      std::size_t samples;
+   };
+
+   /**
+    * How benchmark cases are measured and judged.
+    */
+   struct settings
+   {
+      // minimum duration of a sample; calibration raises the iteration count until a sample takes at least this long
+      double sample_seconds = 0.002;
+
+      // number of timed samples per case; at least 100 are needed for the 99th percentile to differ from the maximum
+      std::size_t samples = 101;
+
+      // time spent running a case after calibration and before the first timed sample
+      double warmup_seconds = 0.05;
+
+      // slowdown of the median relative to the baseline (0.1 = 10%) beyond which a case is reported as a failure
+      double threshold = 0.1;
+   };
+
+   // median nanoseconds per iteration of each case, by case name
+   typedef std::map<std::string, double> baseline;
+
+   // read a baseline file written by save_baseline(); throws std::runtime_error if the file cannot be read
+   auto load_baseline(std::string const &path) -> baseline;
+
+   // write one "name<tab>median" line per case; throws std::runtime_error if the file cannot be written
+   void save_baseline(std::string const &path, baseline const &medians);
+
+   /**
+    * Ordered list of named benchmark cases. Each case runs the operation being measured the given number of times, so that the cost of calling
+    * the case itself is spread over many iterations. Cases run one after another on the calling thread, since concurrent cases would disturb
+    * each other's timings.
+    */
+   class suite
+   {
+      // a benchmark case: runs the measured operation 'iterations' times
+      public: typedef std::function<void(std::size_t iterations)> case_type;
+
+      // called with the result of each case as soon as it has been measured
+      public: typedef std::function<void(test::result const &)> completion_type;
+
+      // add a case to be run after those already added; names must not contain tabs or newlines
+      public: void add(std::string name, case_type body);
+
+      // measure every case and return one result per case as children of a new result; a case fails if its median is slower than its median
+      // in 'reference' by more than the threshold, and the measured medians are stored in 'measured'; 'on_complete', if given, sees each result
+      // instead of it being kept, so the returned result only holds the overall status
+      public: auto run(std::string description, settings const &config, baseline const &reference, baseline &measured,
+                       completion_type on_complete = nullptr) const -> test::result;
+
+      // the cases, in registration order
+      private: std::vector<std::pair<std::string, case_type>> cases;
+   };
+
+   // calibrate, warm up and time a single case
+   auto measure(suite::case_type const &body, settings const &config) -> statistics;
+
+   // measure every mdt namespace utility benchmark
+   auto run_all(settings const &config, baseline const &reference, baseline &measured, suite::completion_type on_complete = nullptr) -> test::result;
+}}
+
+#ifdef MDT_SELF_TEST
+namespace mdt { namespace test { namespace bench
+{
+   // run all benchmark framework self-tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* BENCH_HPP_ */
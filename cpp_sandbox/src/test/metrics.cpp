@@ -0,0 +1,112 @@
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+
+// std::max()
+#include <algorithm>
+
+// clock_gettime(), CLOCK_THREAD_CPUTIME_ID
+#include <time.h>
+
+// getrusage(), RUSAGE_THREAD
+#include <sys/resource.h>
+
+// mdt::test::metrics, mdt::test::scoped_timer
+#include "metrics.hpp"
+
+// mdt::test::result
+#include "results.hpp"
+
+// string helper functions
+#include "../util/string.hpp"
+
+namespace mdt { namespace test
+{
+   auto metrics::operator+=(metrics const &other) -> metrics &
+   {
+      if(other.recorded)
+      {
+         recorded = true;
+         wall_seconds += other.wall_seconds;
+         cpu_seconds += other.cpu_seconds;
+         voluntary_switches += other.voluntary_switches;
+         involuntary_switches += other.involuntary_switches;
+         peak_rss_delta_kib = std::max(peak_rss_delta_kib, other.peak_rss_delta_kib);
+      }
+
+      return *this;
+   }
+
+   auto metrics::to_string() const -> std::string
+   {
+      return mdt::concat("wall ", mdt::fixed(wall_seconds * 1e3, 3), " ms, cpu ", mdt::fixed(cpu_seconds * 1e3, 3), " ms, switches ",
+                         voluntary_switches, '/', involuntary_switches, ", peak rss +", peak_rss_delta_kib, " KiB");
+   }
+
+   // return the CPU time used by the calling thread, in seconds
+   static auto thread_cpu_seconds() -> double
+   {
+      timespec now{};
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+      return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+   }
+
+   // return the resource usage of the calling thread where the platform can report it, and of the whole process otherwise
+   static auto thread_usage() -> rusage
+   {
+      rusage usage{};
+
+#ifdef RUSAGE_THREAD
+      getrusage(RUSAGE_THREAD, &usage);
+#else
+      getrusage(RUSAGE_SELF, &usage);
+#endif
+
+      return usage;
+   }
+
+   scoped_timer::scoped_timer()
+      :
+      target{nullptr},
+      wall_start{std::chrono::steady_clock::now()},
+      cpu_start{thread_cpu_seconds()}
+   {
+      rusage const usage = thread_usage();
+
+      voluntary_start = usage.ru_nvcsw;
+      involuntary_start = usage.ru_nivcsw;
+      peak_rss_start = usage.ru_maxrss;
+   }
+
+   scoped_timer::scoped_timer(result &target)
+      :
+      scoped_timer{}
+   {
+      this->target = &target;
+   }
+
+   scoped_timer::~scoped_timer()
+   {
+      if(target)
+      {
+         target->set_metrics(elapsed());
+      }
+   }
+
+   auto scoped_timer::elapsed() const -> metrics
+   {
+      rusage const usage = thread_usage();
+
+      metrics m;
+
+      m.recorded = true;
+      m.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+      m.cpu_seconds = thread_cpu_seconds() - cpu_start;
+      m.voluntary_switches = usage.ru_nvcsw - voluntary_start;
+      m.involuntary_switches = usage.ru_nivcsw - involuntary_start;
+      m.peak_rss_delta_kib = usage.ru_maxrss - peak_rss_start;
+
+      return m;
+   }
+}}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+// std::chrono::steady_clock
+#include <chrono>
+
+// std::string
+#include <string>
+
+namespace mdt { namespace test
+{
+   class result;
+
+   /**
+    * Resources used while running a test (or, once aggregated, a group of tests). CPU time and context switches are those of the thread which
+    * ran the test, so work done on threads it started is not included; the peak RSS growth is that of the whole process.
+    */
+   struct metrics
+   {
+      // false until figures have been recorded (or aggregated from a result which has them)
+      bool recorded = false;
+
+      // elapsed wall-clock time
+      double wall_seconds = 0;
+
+      // CPU time used by the thread
+      double cpu_seconds = 0;
+
+      // context switches of the thread which were voluntary (blocking) and involuntary (preemption)
+      long voluntary_switches = 0;
+      long involuntary_switches = 0;
+
+      // growth of the process's peak resident set size, in KiB
+      long peak_rss_delta_kib = 0;
+
+      // aggregate another set of figures into this one: times and switches add up, the peak RSS growth is the larger of the two
+      auto operator+=(metrics const &other) -> metrics &;
+
+      // return the figures for display, e.g., "wall 1.250 ms, cpu 1.100 ms, switches 2/0, peak rss +0 KiB"
+      auto to_string() const -> std::string;
+   };
+
+   /**
+    * Captures the thread's resource usage when created, so that what has been used since can be read with elapsed(). If created for a result,
+    * the figures are recorded in that result when the timer goes out of scope.
+    */
+   class scoped_timer
+   {
+      // start timing
+      public: scoped_timer();
+
+      // start timing, and record the figures in 'target' when the timer goes out of scope
+      public: explicit scoped_timer(result &target);
+
+      // disable copy via constructor operator
+      public: scoped_timer(scoped_timer const &) = delete;
+
+      // disable copy via assignment operator
+      public: scoped_timer & operator=(scoped_timer const &) = delete;
+
+      // record the figures in the target, if any
+      public: ~scoped_timer();
+
+      // return the resources used since the timer was created
+      public: auto elapsed() const -> metrics;
+
+      // the result in which to record the figures, or nullptr
+      private: result *target;
+
+      // wall-clock time when the timer was created
+      private: std::chrono::steady_clock::time_point wall_start;
+
+      // the thread's CPU time and context switch counts, and the process's peak resident set size, when the timer was created
+      private: double cpu_start;
+      private: long voluntary_start;
+      private: long involuntary_start;
+      private: long peak_rss_start;
+   };
+}}
+
+#endif /* METRICS_HPP_ */
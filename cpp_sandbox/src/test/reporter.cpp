@@ -0,0 +1,426 @@
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+
+// std::system_error, std::system_category()
+#include <system_error>
+
+// std::vector
+#include <vector>
+
+// mdt::test::reporter
+#include "reporter.hpp"
+
+// mdt::append_json_escaped()
+#include "../util/string.hpp"
+
+namespace mdt { namespace test
+{
+   reporter::reporter(int fd)
+      :
+      fd{fd}
+   {}
+
+   void reporter::begin()
+   {
+      on_begin();
+      flush();
+   }
+
+   void reporter::group(result const &group)
+   {
+      group.walk([this](result const &node, std::size_t)
+      {
+         if(!node.has_children())
+         {
+            ++tests;
+            failures += !node.is_success();
+         }
+      });
+
+      on_group(group);
+      flush();
+   }
+
+   void reporter::end(std::string const &description, bool success, metrics const &figures)
+   {
+      on_end(description, success, figures);
+      flush();
+
+      if(error)
+      {
+         throw std::system_error(error, std::system_category(), "reporter");
+      }
+   }
+
+   void reporter::flush()
+   {
+      // once a write has failed, the rest of the report is dropped
+      if(!error)
+      {
+         try
+         {
+            output.write_to(fd);
+         }
+         catch(std::system_error const &e)
+         {
+            error = e.code().value();
+         }
+      }
+
+      output.clear();
+   }
+
+   // append the status as it appears in the text report
+   static auto status(bool success) -> char const *
+   {
+      // upper-case "FAILURE" is used to stand out against the lower-case "success" because it's more important
+      return success ? "success" : "FAILURE";
+   }
+
+   // call the visitor with every result of the group along with the descriptions of its ancestors, starting with the group itself
+   template<typename Visitor>
+   static void walk_with_path(result const &group, Visitor visitor)
+   {
+      std::vector<std::string const *> path;
+
+      group.walk([&](result const &node, std::size_t depth)
+      {
+         path.resize(depth);
+         visitor(node, path);
+         path.push_back(&node.get_description());
+      });
+   }
+
+   /**
+    * The indented text of result::to_string(), streamed one group at a time; since the overall status is only known once every group has
+    * completed, the line for the run itself comes last instead of first.
+    */
+   class text_reporter : public reporter
+   {
+      public: explicit text_reporter(int fd) : reporter{fd} {}
+
+      protected: void on_begin() override {}
+
+      protected: void on_group(result const &group) override
+      {
+         group.append_to(output, 1);
+      }
+
+      protected: void on_end(std::string const &description, bool success, metrics const &figures) override
+      {
+         output << '[' << status(success) << "] " << description;
+
+         if(figures.recorded)
+         {
+            output << " (" << figures.to_string() << ')';
+         }
+
+         output << "\n\n";
+      }
+   };
+
+   /**
+    * One JSON object per line: a "begin" event, a "result" event for every result (with the descriptions of its ancestors as "path", and its
+    * metrics if it has any), and an "end" event carrying the overall status and counts.
+    */
+   class json_lines_reporter : public reporter
+   {
+      public: explicit json_lines_reporter(int fd) : reporter{fd} {}
+
+      protected: void on_begin() override
+      {
+         output << "{\"event\":\"begin\"}\n";
+      }
+
+      protected: void on_group(result const &group) override
+      {
+         walk_with_path(group, [this](result const &node, std::vector<std::string const *> const &path)
+         {
+            output << "{\"event\":\"result\",\"path\":[";
+
+            for(std::size_t i = 0; i < path.size(); ++i)
+            {
+               if(i) output << ',';
+               quote(*path[i]);
+            }
+
+            output << "],\"description\":";
+            quote(node.get_description());
+            output << ",\"success\":" << (node.is_success() ? "true" : "false") << ",\"leaf\":" << (node.has_children() ? "false" : "true");
+
+            figures(node.get_metrics());
+
+            output << "}\n";
+         });
+      }
+
+      protected: void on_end(std::string const &description, bool success, metrics const &run_figures) override
+      {
+         output << "{\"event\":\"end\",\"description\":";
+         quote(description);
+         output << ",\"success\":" << (success ? "true" : "false") << ",\"tests\":" << tests << ",\"failures\":" << failures;
+
+         figures(run_figures);
+
+         output << "}\n";
+      }
+
+      // append the metrics as a "metrics" member, if any were recorded
+      private: void figures(metrics const &m)
+      {
+         if(m.recorded)
+         {
+            output << ",\"metrics\":{\"wall_seconds\":" << m.wall_seconds << ",\"cpu_seconds\":" << m.cpu_seconds
+                   << ",\"voluntary_switches\":" << m.voluntary_switches << ",\"involuntary_switches\":" << m.involuntary_switches
+                   << ",\"peak_rss_delta_kib\":" << m.peak_rss_delta_kib << '}';
+         }
+      }
+
+      // append the string as a quoted and escaped JSON string
+      private: void quote(std::string const &s)
+      {
+         escaped.clear();
+         mdt::append_json_escaped(escaped, s);
+
+         output << '"' << escaped << '"';
+      }
+
+      // reused for escaping each string, so that its capacity is only allocated once
+      private: std::string escaped;
+   };
+
+   /**
+    * JUnit XML: one <testsuite> per group holding a <testcase> for every result without children, named after the path to it from the group,
+    * with the wall time of those which have metrics. The counts of the run are only known at the end, so the enclosing <testsuites> has none.
+    */
+   class junit_reporter : public reporter
+   {
+      public: explicit junit_reporter(int fd) : reporter{fd} {}
+
+      protected: void on_begin() override
+      {
+         output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n";
+      }
+
+      protected: void on_group(result const &group) override
+      {
+         std::size_t cases = 0;
+         std::size_t failed = 0;
+
+         group.walk([&](result const &node, std::size_t)
+         {
+            if(!node.has_children())
+            {
+               ++cases;
+               failed += !node.is_success();
+            }
+         });
+
+         output << "  <testsuite name=\"";
+         escape(group.get_description());
+         output << "\" tests=\"" << cases << "\" failures=\"" << failed << '"';
+         time(group);
+         output << ">\n";
+
+         walk_with_path(group, [&](result const &node, std::vector<std::string const *> const &path)
+         {
+            if(node.has_children())
+            {
+               return;
+            }
+
+            output << "    <testcase classname=\"";
+            escape(group.get_description());
+            output << "\" name=\"";
+
+            // the path below the group, then the result itself
+            for(std::size_t i = 1; i < path.size(); ++i)
+            {
+               escape(*path[i]);
+               output << " / ";
+            }
+
+            escape(node.get_description());
+            output << '"';
+            time(node);
+
+            if(node.is_success())
+            {
+               output << "/>\n";
+            }
+            else
+            {
+               output << ">\n      <failure message=\"FAILURE\"/>\n    </testcase>\n";
+            }
+         });
+
+         output << "  </testsuite>\n";
+      }
+
+      protected: void on_end(std::string const &, bool, metrics const &) override
+      {
+         output << "</testsuites>\n";
+      }
+
+      // append the wall time as a "time" attribute (in seconds), if the result has metrics
+      private: void time(result const &r)
+      {
+         if(r.get_metrics().recorded)
+         {
+            output << " time=\"" << mdt::fixed(r.get_metrics().wall_seconds, 6) << '"';
+         }
+      }
+
+      // append the string escaped for use in an attribute value
+      private: void escape(std::string const &s)
+      {
+         for(char c : s)
+         {
+            switch(c)
+            {
+               case '&':  output << "&amp;"; break;
+               case '<':  output << "&lt;"; break;
+               case '>':  output << "&gt;"; break;
+               case '"':  output << "&quot;"; break;
+               case '\n': output << "&#10;"; break;
+               default:   output << c;
+            }
+         }
+      }
+   };
+
+   auto make_reporter(std::string const &format, int fd) -> std::unique_ptr<reporter>
+   {
+      if(format == "text")  return std::unique_ptr<reporter>{new text_reporter{fd}};
+      if(format == "jsonl") return std::unique_ptr<reporter>{new json_lines_reporter{fd}};
+      if(format == "junit") return std::unique_ptr<reporter>{new junit_reporter{fd}};
+
+      return nullptr;
+   }
+}}
+
+#endif
+
+#ifdef MDT_SELF_TEST
+
+// pipe(), read(), close()
+#include <unistd.h>
+
+namespace mdt { namespace test { namespace reporters
+{
+   // report a small run through a reporter of the given format and return everything it wrote
+   static auto report(std::string const &format) -> std::string
+   {
+      test::result run{"run"};
+
+      auto first = run.append_child(test::result{"first"} << test::result{"a \"quoted\"\nline"} << (test::result{"nested"} << test::result{"b & c", false}));
+      auto second = run.append_child(test::result{"second"});
+
+      // only the second group has metrics
+      metrics figures;
+      figures.wall_seconds = 0.5;
+      figures.cpu_seconds = 0.25;
+      figures.voluntary_switches = 2;
+      figures.peak_rss_delta_kib = 16;
+      second.set_metrics(figures);
+
+      int fds[2];
+
+      if(pipe(fds))
+      {
+         return {};
+      }
+
+      {
+         auto const r = make_reporter(format, fds[1]);
+
+         r->begin();
+         r->group(first);
+         r->group(second);
+         r->end(run.get_description(), run.is_success(), run.get_metrics());
+      }
+
+      close(fds[1]);
+
+      // the reports are small enough to fit in the pipe's buffer
+      std::string text;
+      char buffer[4096];
+
+      for(ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) > 0;)
+      {
+         text.append(buffer, static_cast<std::size_t>(n));
+      }
+
+      close(fds[0]);
+
+      return text;
+   }
+
+   auto all() -> result
+   {
+      test::result result{"reporter tests"};
+
+      /**
+       * (1) Ensure that the text backend writes the groups in to_string() form, followed by the run.
+       */
+      {
+         result << test::result
+         {
+            "text report -> groups, then the run",
+            report("text") == "[FAILURE] .. first\n[success] ..... a \"quoted\"\nline\n[FAILURE] ..... nested\n[FAILURE] ........ b & c\n"
+                              "[success] .. second (wall 500.000 ms, cpu 250.000 ms, switches 2/0, peak rss +16 KiB)\n"
+                              "[FAILURE] run (wall 500.000 ms, cpu 250.000 ms, switches 2/0, peak rss +16 KiB)\n\n"
+         };
+      }
+
+      /**
+       * (2) Ensure that the JSON Lines backend writes one escaped object per result, between the begin and end events.
+       */
+      {
+         result << test::result
+         {
+            "JSON Lines report -> one object per result",
+            report("jsonl") ==
+               "{\"event\":\"begin\"}\n"
+               "{\"event\":\"result\",\"path\":[],\"description\":\"first\",\"success\":false,\"leaf\":false}\n"
+               "{\"event\":\"result\",\"path\":[\"first\"],\"description\":\"a \\\"quoted\\\"\\nline\",\"success\":true,\"leaf\":true}\n"
+               "{\"event\":\"result\",\"path\":[\"first\"],\"description\":\"nested\",\"success\":false,\"leaf\":false}\n"
+               "{\"event\":\"result\",\"path\":[\"first\",\"nested\"],\"description\":\"b & c\",\"success\":false,\"leaf\":true}\n"
+               "{\"event\":\"result\",\"path\":[],\"description\":\"second\",\"success\":true,\"leaf\":true,\"metrics\":{\"wall_seconds\":0.5,"
+               "\"cpu_seconds\":0.25,\"voluntary_switches\":2,\"involuntary_switches\":0,\"peak_rss_delta_kib\":16}}\n"
+               "{\"event\":\"end\",\"description\":\"run\",\"success\":false,\"tests\":3,\"failures\":1,\"metrics\":{\"wall_seconds\":0.5,"
+               "\"cpu_seconds\":0.25,\"voluntary_switches\":2,\"involuntary_switches\":0,\"peak_rss_delta_kib\":16}}\n"
+         };
+      }
+
+      /**
+       * (3) Ensure that the JUnit backend writes one test suite per group and one escaped test case per result without children.
+       */
+      {
+         result << test::result
+         {
+            "JUnit report -> suites of test cases",
+            report("junit") ==
+               "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n"
+               "  <testsuite name=\"first\" tests=\"2\" failures=\"1\">\n"
+               "    <testcase classname=\"first\" name=\"a &quot;quoted&quot;&#10;line\"/>\n"
+               "    <testcase classname=\"first\" name=\"nested / b &amp; c\">\n      <failure message=\"FAILURE\"/>\n    </testcase>\n"
+               "  </testsuite>\n"
+               "  <testsuite name=\"second\" tests=\"1\" failures=\"0\" time=\"0.500000\">\n"
+               "    <testcase classname=\"second\" name=\"second\" time=\"0.500000\"/>\n"
+               "  </testsuite>\n"
+               "</testsuites>\n"
+         };
+      }
+
+      /**
+       * (4) Ensure that unknown formats are rejected.
+       */
+      {
+         result << test::result{"unknown format -> no reporter", !make_reporter("yaml", 1)};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
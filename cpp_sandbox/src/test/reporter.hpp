@@ -0,0 +1,90 @@
+#ifndef REPORTER_HPP_
+#define REPORTER_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::unique_ptr
+#include <memory>
+
+// std::string
+#include <string>
+
+// mdt::test::result
+#include "results.hpp"
+
+// mdt::rope
+#include "../util/rope.hpp"
+
+namespace mdt { namespace test
+{
+   /**
+    * Writes a run's results to a file descriptor as they become available, one group (top-level result) at a time, rather than printing the
+    * whole tree once the run is over. Each group is formatted into a rope which is written out and cleared as soon as the group is reported, so
+    * a crash or hang loses at most the groups which had not completed yet. Backends only format; buffering and writing are done here.
+    */
+   class reporter
+   {
+      // report to the file descriptor (which is not closed by the reporter)
+      public: explicit reporter(int fd);
+
+      // disable copy via constructor operator
+      public: reporter(reporter const &) = delete;
+
+      // disable copy via assignment operator
+      public: reporter & operator=(reporter const &) = delete;
+
+      // virtual destructor, since backends are owned through this class
+      public: virtual ~reporter() = default;
+
+      // start the report
+      public: void begin();
+
+      // report one group and write it out
+      public: void group(result const &group);
+
+      // finish the report with the description, overall status and figures of the run (whose groups have all been reported, and counted);
+      // throws std::system_error if any write failed
+      public: void end(std::string const &description, bool success, metrics const &figures);
+
+      // backend: append the start of the report to 'output'
+      protected: virtual void on_begin() = 0;
+
+      // backend: append one group to 'output'
+      protected: virtual void on_group(result const &group) = 0;
+
+      // backend: append the end of the report to 'output'
+      protected: virtual void on_end(std::string const &description, bool success, metrics const &figures) = 0;
+
+      // number of results without children reported so far...
+      protected: std::size_t tests = 0;
+
+      // ...and how many of those failed
+      protected: std::size_t failures = 0;
+
+      // text waiting to be written
+      protected: mdt::rope output;
+
+      // write out and clear 'output', remembering the first failure instead of throwing (groups may be reported from worker threads)
+      private: void flush();
+
+      // the file descriptor to report to
+      private: int fd;
+
+      // error number of the first failed write, or 0
+      private: int error = 0;
+   };
+
+   // return a reporter for the format ("text", "jsonl" or "junit") writing to 'fd', or nullptr if the format is unknown
+   auto make_reporter(std::string const &format, int fd) -> std::unique_ptr<reporter>;
+}}
+
+#ifdef MDT_SELF_TEST
+namespace mdt { namespace test { namespace reporters
+{
+   // run all reporter self-tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* REPORTER_HPP_ */
@@ -1,17 +1,56 @@
-#ifdef MDT_SELF_TEST
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
 
 // assert()
 #include <cassert>
 
+// std::vector
+#include <vector>
+
 // mdt::test::run_all()
 #include "run_tests.hpp"
 
 // mdt::test::result
 #include "results.hpp"
 
+// mdt::test::registry
+#include "runner.hpp"
+
+// mdt::bench
+#include "bench.hpp"
+
+// mdt::test::reporter
+#include "reporter.hpp"
+
+// allocation tracking
+#include "../util/alloc_tracker.hpp"
+
+// mdt::format()
+#include "../util/format.hpp"
+
+// mdt::interned_string
+#include "../util/interned_string.hpp"
+
+// mdt::message_queue
+#include "../util/message_queue.hpp"
+
+// number formatting functions
+#include "../util/number_format.hpp"
+
 // mdt::pending_queue
 #include "../util/pending_queue.hpp"
 
+// mdt::recycle_pool
+#include "../util/recycle_pool.hpp"
+
+// mdt::rope
+#include "../util/rope.hpp"
+
+// mdt::slot_queue
+#include "../util/slot_queue.hpp"
+
+// per-element tracing
+#include "../util/trace.hpp"
+
 // string helper functions
 #include "../util/string.hpp"
 
@@ -19,116 +58,525 @@ namespace mdt { namespace test
 {
    class result::private_data
    {
-      public: private_data(std::string description, bool success) : description{description}, success{success} {}
+      // marks a missing parent, child or sibling
+      public: static constexpr std::size_t none = static_cast<std::size_t>(-1);
 
-      // description of the result or result group
-      public: std::string description;
+      // one result within the arena
+      public: struct node
+      {
+         // description of the result or result group
+         std::string description;
 
-      // success status of the result
-      public: bool success;
+         // success status of the result
+         bool success;
 
-      // the first child result, if any
-      public: result child;
+         // the parent, first child, last child and next sibling of the result, or 'none'
+         std::size_t parent;
+         std::size_t first_child;
+         std::size_t last_child;
+         std::size_t next;
 
-      // the next result, if any
-      public: result next;
+         // the resources recorded for the result itself...
+         metrics own;
+
+         // ...and those reported for it: its own if it has any, otherwise the aggregate of its children's
+         metrics total;
+      };
+
+      // create an arena holding a single result
+      public: private_data(std::string description, bool success) : last_root{0}, offset{0}
+      {
+         nodes.push_back({std::move(description), success, none, none, none, none, metrics{}, metrics{}});
+      }
+
+      // every node of the tree; index 0 is the first top-level result
+      public: std::vector<node> nodes;
+
+      // the last top-level result (top-level results are siblings of node 0)
+      public: std::size_t last_root;
+
+      // once the tree has been appended to another result, the arena now holding its nodes...
+      public: std::shared_ptr<private_data> moved_to;
+
+      // ...and the index there of what was node 0 here
+      public: std::size_t offset;
    };
 
+   constexpr std::size_t result::private_data::none;
+
    result::result(std::string description, bool success)
       :
-      // create the private data block with the description and success status filled out
-      data(std::make_shared<private_data>(description, success))
+      // hold the description and success status inline until the result is appended somewhere
+      is_inline(true),
+      description(std::move(description)),
+      success(success)
    {}
 
-   auto result::append_sibling(result &&next) -> result &
+   result::result(result &&other)
+      :
+      data(std::move(other.data)),
+      index(other.index),
+      is_inline(other.is_inline),
+      description(std::move(other.description)),
+      success(other.success),
+      own(other.own)
+   {
+      other.index = 0;
+      other.is_inline = false;
+   }
+
+   auto result::operator=(result &&other) -> result &
+   {
+      if(this != &other)
+      {
+         data = std::move(other.data);
+         index = other.index;
+         is_inline = other.is_inline;
+         description = std::move(other.description);
+         success = other.success;
+         own = other.own;
+
+         other.index = 0;
+         other.is_inline = false;
+      }
+
+      return *this;
+   }
+
+   result::result(std::shared_ptr<private_data> data, std::size_t index)
+      :
+      data(std::move(data)),
+      index(index)
+   {}
+
+   void result::materialize()
+   {
+      if(!is_inline || data)
+      {
+         return;
+      }
+
+      // the inline members are left as they are; from now on the arena takes precedence over them
+      data = std::make_shared<private_data>(description, success);
+      index = 0;
+
+      if(own.recorded)
+      {
+         data->nodes[0].own = own;
+         data->nodes[0].total = own;
+      }
+   }
+
+   auto result::locate(std::size_t &i) const -> std::shared_ptr<private_data> const &
+   {
+      std::shared_ptr<private_data> const *arena = &data;
+      i = index;
+
+      // follow the chain of arenas this tree has been moved into, translating the index along the way
+      while(*arena && (*arena)->moved_to)
+      {
+         i += (*arena)->offset;
+         arena = &(*arena)->moved_to;
+      }
+
+      return *arena;
+   }
+
+   void result::resolve()
+   {
+      std::size_t i;
+      std::shared_ptr<private_data> arena = locate(i);
+
+      data = std::move(arena);
+      index = i;
+   }
+
+   auto result::adopt(result &&other, std::size_t parent) -> std::size_t
    {
+      other.resolve();
+
+      auto &target = data->nodes;
+
+      std::size_t const offset = target.size();
+      std::size_t last;
+
+      if(!other.data)
+      {
+         assert(other.is_inline);
+
+         // an inline result becomes a single node, without ever having had an arena of its own
+         target.push_back({std::move(other.description), other.success, private_data::none, private_data::none, private_data::none, private_data::none,
+                           other.own, other.own});
+
+         last = offset;
+      }
+      else
+      {
+         assert(other.data != data);
+
+         // only whole trees can be appended
+         assert(other.index == 0);
+
+         auto &source = other.data->nodes;
+
+         // move every node over, shifting its links by the offset
+         for(auto &n : source)
+         {
+            auto shift = [offset](std::size_t i) { return i == private_data::none ? i : i + offset; };
+
+            target.push_back({std::move(n.description), n.success, shift(n.parent), shift(n.first_child), shift(n.last_child), shift(n.next), n.own, n.total});
+         }
+
+         // leave a forwarding address for any other handles to the appended tree
+         last = other.data->last_root + offset;
+
+         source.clear();
+         source.shrink_to_fit();
+         other.data->moved_to = data;
+         other.data->offset = offset;
+         other.data.reset();
+      }
+
+      // the appended result now lives in this arena, leaving 'other' empty
+      other.is_inline = false;
+
+      bool success = true;
+      metrics added;
+
+      // the top-level results of the appended tree become children of 'parent'
+      for(std::size_t i = offset; i != private_data::none; i = target[i].next)
+      {
+         target[i].parent = parent;
+         success = success && target[i].success;
+         added += target[i].total;
+      }
+
+      // their metrics add up into every ancestor which has none of its own (aggregates only ever grow, so adding them is enough)
+      if(added.recorded)
+      {
+         for(std::size_t i = parent; i != private_data::none && !target[i].own.recorded; i = target[i].parent)
+         {
+            target[i].total += added;
+         }
+      }
+
+      // a failure marks every ancestor as failed
+      if(!success)
+      {
+         for(std::size_t i = parent; i != private_data::none; i = target[i].parent)
+         {
+            target[i].success = false;
+         }
+      }
+
+      return last;
+   }
+
+   auto result::append_sibling(result &&next) -> result
+   {
+      materialize();
+      resolve();
       assert(data);
 
-      // return a reference to the next node after adding it
-      return(data->next ? data->next.append_sibling(std::move(next)) : (data->next = std::move(next)));
+      auto &nodes = data->nodes;
+      std::size_t const parent = nodes[index].parent;
+      std::size_t const first = nodes.size();
+
+      std::size_t const last = adopt(std::move(next), parent);
+
+      // link the new results after the current last sibling
+      std::size_t &previous_last = parent == private_data::none ? data->last_root : data->nodes[parent].last_child;
+
+      data->nodes[previous_last].next = first;
+      previous_last = last;
+
+      // return a handle to the next node after adding it
+      return result{data, first};
    }
 
-   auto result::append_child(result &&child) -> result &
+   auto result::append_child(result &&child) -> result
    {
+      materialize();
+      resolve();
       assert(data);
 
-      // set success to false if the new child is already false
-      if(!child.is_success()) data->success = false;
+      std::size_t const first = data->nodes.size();
+      std::size_t const last = adopt(std::move(child), index);
+
+      auto &n = data->nodes[index];
 
-      // return a reference to the child node after adding it
-      return(data->child ? data->child.append_sibling(std::move(child)) : (data->child = std::move(child)));
+      // link the new results after the current last child, if any
+      if(n.first_child == private_data::none)
+      {
+         n.first_child = first;
+      }
+      else
+      {
+         data->nodes[n.last_child].next = first;
+      }
+
+      n.last_child = last;
+
+      // return a handle to the child node after adding it
+      return result{data, first};
    }
 
    result::operator bool() const
    {
-      // returns true if the private data instance exits
-      return !!data;
+      // returns true if the result is held inline or the private data instance exits
+      return is_inline || data;
    }
 
    auto result::is_success() const -> bool
    {
-      assert(data);
+      std::size_t i;
+      auto const &arena = locate(i);
+
+      if(!arena)
+      {
+         assert(is_inline);
+         return success;
+      }
 
       // return the success status
-      return(data->success);
+      return(arena->nodes[i].success);
    }
 
    auto result::get_description() const -> std::string const &
    {
-      assert(data);
+      std::size_t i;
+      auto const &arena = locate(i);
+
+      if(!arena)
+      {
+         assert(is_inline);
+         return description;
+      }
 
       // return the description of the result
-      return(data->description);
+      return(arena->nodes[i].description);
+   }
+
+   void result::set_metrics(metrics const &figures)
+   {
+      resolve();
+
+      if(!data)
+      {
+         assert(is_inline);
+         own = figures;
+         own.recorded = true;
+         return;
+      }
+
+      auto &n = data->nodes[index];
+
+      n.own = figures;
+      n.own.recorded = true;
+      n.total = n.own;
+
+      reaggregate(index);
    }
 
-   auto result::to_string() const -> std::string
+   void result::reaggregate(std::size_t i)
+   {
+      auto &nodes = data->nodes;
+
+      // the figures of node 'i' may have shrunk, so each ancestor without figures of its own is aggregated again from its children
+      for(i = nodes[i].parent; i != private_data::none && !nodes[i].own.recorded; i = nodes[i].parent)
+      {
+         metrics total;
+
+         for(std::size_t c = nodes[i].first_child; c != private_data::none; c = nodes[c].next)
+         {
+            total += nodes[c].total;
+         }
+
+         nodes[i].total = total;
+      }
+   }
+
+   auto result::get_metrics() const -> metrics const &
+   {
+      std::size_t i;
+      auto const &arena = locate(i);
+
+      if(!arena)
+      {
+         assert(is_inline);
+         return own;
+      }
+
+      return arena->nodes[i].total;
+   }
+
+   auto result::has_children() const -> bool
+   {
+      std::size_t i;
+      auto const &arena = locate(i);
+
+      if(!arena)
+      {
+         assert(is_inline);
+         return false;
+      }
+
+      return arena->nodes[i].first_child != private_data::none;
+   }
+
+   void result::walk(std::function<void(result const &node, std::size_t depth)> const &visitor) const
+   {
+      std::size_t start;
+      auto const &arena = locate(start);
+
+      if(!arena)
+      {
+         // an inline result is visited as it is
+         if(is_inline)
+         {
+            visitor(*this, 0);
+         }
+
+         return;
+      }
+
+      auto const &nodes = arena->nodes;
+      auto const none = private_data::none;
+      std::size_t depth = 0;
+
+      // same traversal as to_string(), except that the siblings of this result are not visited
+      for(std::size_t i = start; i != none;)
+      {
+         visitor(result{arena, i}, depth);
+
+         if(nodes[i].first_child != none)
+         {
+            i = nodes[i].first_child;
+            ++depth;
+            continue;
+         }
+
+         while(depth && nodes[i].next == none)
+         {
+            i = nodes[i].parent;
+            --depth;
+         }
+
+         i = depth ? nodes[i].next : none;
+      }
+   }
+
+   auto result::to_string(bool with_metrics) const -> std::string
    {
       // create a string to hold the result
       std::string result;
 
       // populate the string with every result
-      to_string(result, 0);
+      to_string(result, 0, with_metrics, true);
 
       // return the result via move
       return result;
    }
 
-   void result::to_string(std::string &input, size_t indentation) const
+   auto result::to_rope(bool with_metrics) const -> mdt::rope
    {
-      // if the private data doesn't exist, this result doesn't add to the input
-      if(!data)
-      {
-         return;
-      }
+      // create a rope to hold the result
+      mdt::rope result;
+
+      // populate the rope with every result
+      to_string(result, 0, with_metrics, true);
+
+      // return the result via move
+      return result;
+   }
+
+   void result::append_to(mdt::rope &output, std::size_t depth, bool with_metrics) const
+   {
+      to_string(output, depth * 3, with_metrics, false);
+   }
+
+   // append the line of a single result to the output (a std::string or an mdt::rope)
+   template<typename Output>
+   static void append_line(Output &output, size_t indentation, std::string const &description, bool success, metrics const &figures,
+                           bool with_metrics)
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
 
       // upper-case "FAILURE" is used to stand out against the lower-case "success" because it's more important
-      input += '[';
-      input += (data->success ? "success" : "FAILURE");
-      input += "] ";
+      output << '[' << (success ? "success" : "FAILURE") << "] ";
 
       // add the dotted line (if required) to the indented result description, leaving a space on both sides
       if(indentation > 1)
       {
-         input += std::string(indentation - 1, '.');
-         input += ' ';
+         output << mdt::pad('.', static_cast<unsigned>(indentation - 1), '.') << ' ';
       }
 
-      // add the description
-      input += data->description;
+      // add the description, followed by the metrics if there are any; note that because of the newline, even the final line will be empty
+      output << description;
+
+      if(with_metrics && figures.recorded)
+      {
+         output << " (" << figures.to_string() << ')';
+      }
+
+      output << '\n';
+   }
 
-      // note that because of this, even the final line will be empty
-      input += '\n';
+   template<typename Output>
+   void result::to_string(Output &output, size_t indentation, bool with_metrics, bool siblings) const
+   {
+      std::size_t start;
+      auto const &arena = locate(start);
 
-      // add the same data for each child
-      if(data->child)
+      // an inline result is a single line, read straight from its members; an empty result doesn't add to the output
+      if(!arena)
       {
-         data->child.to_string(input, indentation + 3);
+         if(is_inline)
+         {
+            append_line(output, indentation, description, success, own, with_metrics);
+         }
+
+         return;
       }
 
-      // add the same data for the next sibling
-      if(data->next)
+      auto const &nodes = arena->nodes;
+      auto const none = private_data::none;
+      std::size_t const base = indentation;
+
+      // walk this result, its descendants and its following siblings in order, without recursion
+      for(std::size_t i = start; i != none;)
       {
-         data->next.to_string(input, indentation);
+         auto const &n = nodes[i];
+
+         append_line(output, indentation, n.description, n.success, n.total, with_metrics);
+
+         // descend into the children first...
+         if(n.first_child != none)
+         {
+            i = n.first_child;
+            indentation += 3;
+            continue;
+         }
+
+         // ...then move on to the next sibling, climbing back up (but never above the starting level, nor past it without 'siblings') until one exists
+         while(i != none && (nodes[i].next == none || (!siblings && indentation == base)))
+         {
+            if(indentation == base)
+            {
+               i = none;
+            }
+            else
+            {
+               i = nodes[i].parent;
+               indentation -= 3;
+            }
+         }
+
+         if(i != none)
+         {
+            i = nodes[i].next;
+         }
       }
    }
 
@@ -147,14 +595,220 @@ namespace mdt { namespace test
    }
 }}
 
+#endif
+
+#ifdef MDT_SELF_TEST
+
+// std::thread
+#include <thread>
+
+namespace mdt { namespace test { namespace results
+{
+   auto all() -> result
+   {
+      test::result result{"result tests"};
+
+      /**
+       * (1) Ensure that failures propagate to every ancestor, including through handles returned by append_child().
+       */
+      {
+         test::result root{"root"};
+         auto group = root.append_child(test::result{"group"});
+
+         group.append_child(test::result{"passes"});
+
+         bool const passing = root.is_success() && group.is_success();
+
+         group.append_sibling(test::result{"fails", false});
+
+         result << test::result{"failing sibling -> failed parent", passing && !root.is_success() && group.is_success()};
+      }
+
+      /**
+       * (2) Ensure that handles into a tree stay valid after the tree is appended to another result.
+       */
+      {
+         test::result inner{"inner"};
+         auto leaf = inner.append_child(test::result{"leaf"});
+
+         test::result outer{"outer"};
+         outer << std::move(inner);
+
+         leaf.append_child(test::result{"late", false});
+
+         result << test::result
+         {
+            "handle after append -> same node", leaf.get_description() == "leaf" && !outer.is_success() &&
+            outer.to_string() == "[FAILURE] outer\n[FAILURE] .. inner\n[FAILURE] ..... leaf\n[FAILURE] ........ late\n"
+         };
+      }
+
+      /**
+       * (3) Ensure that large flat and deep trees are built and printed without quadratic work or deep recursion.
+       */
+      {
+         test::result flat{"flat"};
+
+         for(int i = 0; i < 100000; ++i)
+         {
+            flat << test::result{"case"};
+         }
+
+         test::result deep{"level"};
+         auto bottom = deep.append_child(test::result{"level"});
+
+         for(int i = 0; i < 1000; ++i)
+         {
+            bottom = bottom.append_child(test::result{"level"});
+         }
+
+         result << test::result{"100000 children", flat.to_string().size() == 15 + 100000 * 18};
+         result << test::result{"1000 levels", deep.to_string().size() > 1000 * 3000 / 2};
+      }
+
+      /**
+       * (4) Ensure that metrics aggregate up the tree: times and switches add up, the peak RSS growth is the largest, and recorded figures win.
+       */
+      {
+         auto figures = [](double wall, long switches, long rss)
+         {
+            metrics m;
+            m.wall_seconds = wall;
+            m.voluntary_switches = switches;
+            m.peak_rss_delta_kib = rss;
+            return m;
+         };
+
+         test::result root{"root"};
+         auto group = root.append_child(test::result{"group"});
+         auto first = group.append_child(test::result{"first"});
+
+         first.set_metrics(figures(0.25, 1, 8));
+
+         test::result second{"second"};
+         second.set_metrics(figures(0.5, 2, 4));
+         group << std::move(second);
+
+         metrics const aggregated = root.get_metrics();
+
+         // shrinking a child's figures shrinks the aggregate...
+         first.set_metrics(figures(0, 0, 0));
+         metrics const shrunk = root.get_metrics();
+
+         // ...and figures recorded for the group itself replace those of its children
+         group.set_metrics(figures(1, 0, 0));
+         metrics const recorded = root.get_metrics();
+
+         result << test::result
+         {
+            "children -> aggregated metrics",
+            aggregated.recorded && aggregated.wall_seconds == 0.75 && aggregated.voluntary_switches == 3 && aggregated.peak_rss_delta_kib == 8 &&
+            shrunk.wall_seconds == 0.5 && shrunk.voluntary_switches == 2 && shrunk.peak_rss_delta_kib == 4
+         };
+
+         result << test::result{"recorded metrics replace aggregated ones", recorded.wall_seconds == 1 && recorded.voluntary_switches == 0};
+         result << test::result{"no metrics -> none aggregated", !test::result{"plain"}.get_metrics().recorded};
+
+         result << test::result
+         {
+            "to_string() with and without metrics",
+            root.to_string(false) == "[success] root\n[success] .. group\n[success] ..... first\n[success] ..... second\n" &&
+            root.to_string().find("[success] ..... second (wall 500.000 ms, cpu 0.000 ms, switches 2/0, peak rss +4 KiB)\n") != std::string::npos
+         };
+      }
+
+      /**
+       * (5) Ensure that a single result is held inline, so that appending it allocates nothing beyond the growth of the parent's arena.
+       */
+      {
+         test::result flat{"flat"};
+         flat << test::result{"first"};
+
+         auto const before = mdt::thread_alloc_counts();
+
+         for(int i = 0; i < 100000; ++i)
+         {
+            flat << test::result{"case", i % 2 == 0};
+         }
+
+         auto const made = mdt::thread_alloc_counts() - before;
+
+         // printing an inline result reads its members as they are, which must not change how it is appended afterwards
+         test::result printed{"printed", false};
+         std::string const text = printed.to_string();
+
+         test::result parent{"parent"};
+         parent << std::move(printed);
+
+         result << test::result{"inline children -> only arena growth allocates", made.allocations < 64 && !flat.is_success()};
+         result << test::result
+         {
+            "inline result printed, then appended",
+            text == "[FAILURE] printed\n" && parent.to_string() == "[FAILURE] parent\n[FAILURE] .. printed\n" && !printed
+         };
+      }
+
+      /**
+       * (6) Ensure that const functions never write to the handle, so that several threads may print the same inline result, or the same handle
+       *     to a tree which has since been appended elsewhere, at once.
+       */
+      {
+         test::result const single{"single", false};
+
+         test::result inner{"inner"};
+         auto const leaf = inner.append_child(test::result{"leaf"});
+
+         test::result outer{"outer"};
+         outer << std::move(inner);
+
+         std::string texts[4];
+
+         auto print = [&](std::size_t slot)
+         {
+            texts[slot] = single.to_string();
+            texts[slot + 1] = leaf.to_string() + leaf.get_description();
+         };
+
+         std::thread other{print, 2};
+         print(0);
+         other.join();
+
+         result << test::result
+         {
+            "concurrent printing of the same results",
+            texts[0] == "[FAILURE] single\n" && texts[1] == "[success] leaf\nleaf" && texts[2] == texts[0] && texts[3] == texts[1]
+         };
+      }
+
+      return result;
+   }
+}}}
+
 namespace mdt { namespace test
 {
-   auto run_all() -> result
+   auto run_all(std::size_t jobs, registry::completion_type on_complete) -> result
    {
+      // register every mdt namespace utility test group, in the order in which the results are reported
+      registry groups;
+
+      groups.add(test::results::all);
+      groups.add(test::runner::all);
+      groups.add(test::bench::all);
+      groups.add(test::reporters::all);
+      groups.add(test::pending_queue::all);
+      groups.add(test::recycle_pool::all);
+      groups.add(test::message_queue::all);
+      groups.add(test::number_format::all);
+      groups.add(test::string::all);
+      groups.add(test::rope::all);
+      groups.add(test::interned_string::all);
+      groups.add(test::format::all);
+      groups.add(test::slot_queue::all);
+      groups.add(test::alloc_tracker::all);
+      groups.add(test::trace::all);
+
       // test all mdt namespace utilities and return the results
-      return result{"mdt utility tests"}
-             << test::pending_queue::all()
-             << test::string::all();
+      return groups.run("mdt utility tests", jobs, std::move(on_complete));
    }
 }}
 
@@ -1,33 +1,47 @@
 #ifndef RESULTS_HPP_
 #define RESULTS_HPP_
 
-// std::list
-#include <list>
+// std::size_t
+#include <cstddef>
+
+// std::function
+#include <functional>
 
 // std::string
 #include <string>
 
-// std::unique_ptr
+// std::shared_ptr
 #include <memory>
 
+// mdt::test::metrics, mdt::test::scoped_timer
+#include "metrics.hpp"
+
+namespace mdt
+{
+   class rope;
+}
+
 namespace mdt { namespace test
 {
    /**
-    * Interface for constructing a nested hierarchy of results.
+    * Interface for constructing a nested hierarchy of results. Every result of a tree lives in one contiguous arena of nodes linked by index, so
+    * appending is O(1) (plus moving the appended tree's nodes into the arena) and printing walks the tree without recursion. A result is a
+    * handle to one node of an arena; handles stay valid when their tree is appended to another result. A single result which has not been
+    * appended to anything yet is held inline instead, so appending it only costs a node in the parent's arena.
     */
    class result
    {
       // create an empty result
       public: result() = default;
 
-      // store a success or fail result tied to a description of the test
+      // store a success or fail result tied to a description of the test (inline, without allocating an arena)
       public: result(std::string description, bool success = true);
 
-      // default move via constructor operator
-      public: result(result &&) = default;
+      // move via constructor operator, leaving 'other' empty
+      public: result(result &&other);
 
-      // default move via assignment operator
-      public: result & operator=(result &&) = default;
+      // move via assignment operator, leaving 'other' empty
+      public: result & operator=(result &&other);
 
       // disable copy via constructor operator
       public: result(result const &) = delete;
@@ -38,11 +52,11 @@ namespace mdt { namespace test
       // default destructor
       public: ~result() = default;
 
-      // insert a result as the last sibling and return a reference to the inserted result
-      public: auto append_sibling(result &&next) -> result &;
+      // insert a result (and its siblings) as the last sibling and return a handle to the inserted result
+      public: auto append_sibling(result &&next) -> result;
 
-      // insert a result as the last child of this result and return a reference to the inserted result
-      public: auto append_child(result &&child) -> result &;
+      // insert a result (and its siblings) as the last child of this result and return a handle to the inserted result
+      public: auto append_child(result &&child) -> result;
 
       // returns false if this is an empty result
       public: explicit operator bool() const;
@@ -53,17 +67,67 @@ namespace mdt { namespace test
       // return the test description
       public: auto get_description() const -> std::string const &;
 
-      // return a nicely-formatted string representation of this instance for display purposes
-      public: auto to_string() const -> std::string;
+      // record the resources used by this result's test; they replace whatever was aggregated from its children
+      public: void set_metrics(metrics const &figures);
+
+      // return the resources recorded for this result or, if none were, the aggregate of those of its children (recorded is false if neither has any)
+      public: auto get_metrics() const -> metrics const &;
+
+      // return true if this result has children
+      public: auto has_children() const -> bool;
+
+      // call the visitor with this result and then each of its descendants in order, along with its depth below this result
+      public: void walk(std::function<void(result const &node, std::size_t depth)> const &visitor) const;
 
-      // for internal use: append this string, with the given indentation, to the input string
-      private: void to_string(std::string &input, size_t indentation) const;
+      // return a nicely-formatted string representation of this instance for display purposes, with the metrics of results which have them
+      public: auto to_string(bool with_metrics = true) const -> std::string;
 
-      // forward-declaration of the class containing the private data
+      // same as to_string(), but built in chunks so that large reports are never copied as they grow
+      public: auto to_rope(bool with_metrics = true) const -> mdt::rope;
+
+      // append the to_string() text of this result and its descendants (but not its following siblings) to the rope, as if this result were
+      // nested 'depth' levels deep
+      public: void append_to(mdt::rope &output, std::size_t depth = 0, bool with_metrics = true) const;
+
+      // for internal use: append this string, with the given indentation, to the output (a std::string or an mdt::rope), followed by the
+      // following siblings of this result if 'siblings' is true
+      private: template<typename Output> void to_string(Output &output, size_t indentation, bool with_metrics, bool siblings) const;
+
+      // forward-declaration of the class containing the private data (the arena of nodes)
       private: class private_data;
 
-      // owns the private data
+      // create a handle to an existing node
+      private: result(std::shared_ptr<private_data> data, std::size_t index);
+
+      // for internal use: return the arena now holding this handle's node, following the arenas its tree has been moved into without updating the
+      // handle (so that const functions never write to it), and store the node's index there in 'i'; the arena is empty if there is none
+      private: auto locate(std::size_t &i) const -> std::shared_ptr<private_data> const &;
+
+      // for internal use: point this handle at the arena to which its tree has been moved, if any
+      private: void resolve();
+
+      // for internal use: give an inline result an arena of its own, so that it can be linked to other results
+      private: void materialize();
+
+      // for internal use: move the nodes of 'other' (which must be the first node of its tree) under 'parent' and return the index of its last top-level result
+      private: auto adopt(result &&other, std::size_t parent) -> std::size_t;
+
+      // for internal use: re-aggregate the metrics of the ancestors of node 'i' which have none of their own
+      private: void reaggregate(std::size_t i);
+
+      // shares ownership of the arena holding this result
       private: std::shared_ptr<private_data> data;
+
+      // index of this result within the arena
+      private: std::size_t index = 0;
+
+      // true while this result is held inline (in the members below) rather than in an arena
+      private: bool is_inline = false;
+
+      // the description, status and recorded resources of an inline result
+      private: std::string description;
+      private: bool success = true;
+      private: metrics own;
    };
 
    // append a child to this object and return the parent (unlike append_child() which returns the child)
@@ -71,6 +135,26 @@ namespace mdt { namespace test
 
    // same as above but allows for the parent to be an rvalue
    auto operator<<(result &&parent, result &&child) -> result &&;
+
+   // run the body (which returns true on success) and return its result along with the resources it used
+   template<typename Body>
+   auto timed(std::string description, Body body) -> result
+   {
+      scoped_timer timer;
+
+      bool const success = body();
+
+      result r{std::move(description), success};
+      r.set_metrics(timer.elapsed());
+
+      return r;
+   }
 }}
 
+namespace mdt { namespace test { namespace results
+{
+   // run all result self-tests
+   auto all() -> result;
+}}}
+
 #endif /* RESULTS_HPP_ */
@@ -1,12 +1,17 @@
 #ifndef RUN_TESTS_HPP_
 #define RUN_TESTS_HPP_
 
-// mdt::test::result
-#include "results.hpp"
+// std::size_t
+#include <cstddef>
+
+// mdt::test::registry
+#include "runner.hpp"
 
 namespace mdt { namespace test
 {
-   auto run_all() -> result;
+   // run every self-test group on up to 'jobs' threads and return the results in a stable order or, if 'on_complete' is given, pass each group
+   // to it in that order as soon as it is available and return only the overall status
+   auto run_all(std::size_t jobs = 1, registry::completion_type on_complete = nullptr) -> result;
 }}
 
 
@@ -0,0 +1,283 @@
+#ifdef MDT_SELF_TEST
+
+// std::max(), std::min()
+#include <algorithm>
+
+// std::atomic
+#include <atomic>
+
+// std::chrono::milliseconds, std::chrono::steady_clock
+#include <chrono>
+
+// std::exception
+#include <exception>
+
+// std::mutex, std::lock_guard
+#include <mutex>
+
+// std::runtime_error
+#include <stdexcept>
+
+// std::thread
+#include <thread>
+
+// mdt::test::registry
+#include "runner.hpp"
+
+// string helper functions
+#include "../util/string.hpp"
+
+namespace mdt { namespace test
+{
+   // run a single group, turning an escaped exception into a failed result instead of losing the other groups' results
+   static auto run_guarded(registry::group_type const &group) -> result
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
+
+      try
+      {
+         return group();
+      }
+      catch(std::exception const &e)
+      {
+         return result{std::string("test group threw an exception: ") << e.what(), false};
+      }
+      catch(...)
+      {
+         return result{"test group threw an unknown exception", false};
+      }
+   }
+
+   // run a single group and record the resources it used in its result
+   static auto run_group(registry::group_type const &group) -> result
+   {
+      scoped_timer timer;
+
+      result r = run_guarded(group);
+      r.set_metrics(timer.elapsed());
+
+      return r;
+   }
+
+   void registry::add(group_type group)
+   {
+      groups.push_back(std::move(group));
+   }
+
+   auto registry::run(std::string description, std::size_t jobs, completion_type on_complete) const -> result
+   {
+      // times the run itself, since its groups may overlap
+      scoped_timer timer;
+
+      // one slot per group, so that workers never touch each other's results
+      std::vector<result> results(groups.size());
+
+      // which groups have completed, and how many of the first groups have been passed to 'on_complete'
+      std::mutex completion_lock;
+      std::vector<bool> completed(groups.size());
+      std::size_t reported = 0;
+
+      // the status and figures of the groups which have been reported and released
+      bool success = true;
+      metrics totals;
+
+      // run a group, then report (and release) every completed group which is next in registration order
+      auto run_one = [&](std::size_t i)
+      {
+         results[i] = run_group(groups[i]);
+
+         if(on_complete)
+         {
+            std::lock_guard<std::mutex> lock{completion_lock};
+
+            for(completed[i] = true; reported < groups.size() && completed[reported]; ++reported)
+            {
+               on_complete(results[reported]);
+
+               success = success && results[reported].is_success();
+               totals += results[reported].get_metrics();
+               results[reported] = result{};
+            }
+         }
+      };
+
+      std::size_t const workers = std::min(jobs, groups.size());
+
+      if(workers <= 1)
+      {
+         for(std::size_t i = 0; i < groups.size(); ++i)
+         {
+            run_one(i);
+         }
+      }
+      else
+      {
+         // each worker takes the next group which has not been started yet
+         std::atomic<std::size_t> next{0};
+         std::vector<std::thread> threads;
+
+         for(std::size_t w = 0; w < workers; ++w)
+         {
+            threads.emplace_back([this, &next, &run_one]
+            {
+               for(std::size_t i = next++; i < groups.size(); i = next++)
+               {
+                  run_one(i);
+               }
+            });
+         }
+
+         for(auto &thread : threads) thread.join();
+      }
+
+      // the groups have already been reported, so only the run's status and figures are left
+      result merged{std::move(description), success};
+
+      if(!on_complete)
+      {
+         // merge in registration order
+         for(auto &r : results)
+         {
+            totals += r.get_metrics();
+            merged << std::move(r);
+         }
+      }
+
+      // the wall time and peak RSS growth are the run's own; the CPU time and context switches are those of its groups added up, since the
+      // timer only sees the calling thread
+      metrics figures = timer.elapsed();
+      figures.cpu_seconds = totals.cpu_seconds;
+      figures.voluntary_switches = totals.voluntary_switches;
+      figures.involuntary_switches = totals.involuntary_switches;
+
+      merged.set_metrics(figures);
+
+      return merged;
+   }
+}}
+
+namespace mdt { namespace test { namespace runner
+{
+   auto all() -> result
+   {
+      test::result result{"registry tests"};
+
+      /**
+       * (1) Ensure that concurrently-run groups are merged in registration order, whatever order they finish in.
+       */
+      {
+         registry groups;
+
+         for(int i = 0; i < 4; ++i)
+         {
+            groups.add([i]
+            {
+               // the first group registered finishes last
+               std::this_thread::sleep_for(std::chrono::milliseconds(20 * (4 - i)));
+               return test::result{std::to_string(i)};
+            });
+         }
+
+         result << test::result
+         {
+            "parallel run -> registration order", groups.run("groups", 4).to_string(false) == "[success] groups\n[success] .. 0\n[success] .. 1\n"
+                                                                                          "[success] .. 2\n[success] .. 3\n"
+         };
+      }
+
+      /**
+       * (2) Ensure that a group which throws becomes a failed result without affecting the others.
+       */
+      {
+         registry groups;
+
+         groups.add([]() -> test::result { throw std::runtime_error("boom"); });
+         groups.add([] { return test::result{"fine"}; });
+
+         auto const merged = groups.run("groups", 2);
+
+         result << test::result
+         {
+            "throwing group -> failed result",
+            merged.to_string(false) == "[FAILURE] groups\n[FAILURE] .. test group threw an exception: boom\n[success] .. fine\n"
+         };
+      }
+
+      /**
+       * (3) Ensure that groups are passed to the completion call-back in registration order, whatever order they finish in.
+       */
+      {
+         registry groups;
+
+         for(int i = 0; i < 4; ++i)
+         {
+            groups.add([i]
+            {
+               std::this_thread::sleep_for(std::chrono::milliseconds(10 * (i % 2 ? 1 : 4)));
+               return test::result{std::to_string(i), i != 2};
+            });
+         }
+
+         std::string order;
+
+         auto const merged = groups.run("groups", 4, [&order](test::result const &group)
+         {
+            order += group.get_description() + (group.is_success() ? "+" : "-");
+         });
+
+         result << test::result{"completion call-back -> registration order", order == "0+1+2-3+" && !merged.is_success()};
+         result << test::result{"completion call-back -> groups released", !merged.has_children() && merged.get_description() == "groups"};
+      }
+
+      /**
+       * (4) Ensure that each group is timed, and that the run is timed as a whole (concurrent groups overlap) while its CPU time adds up.
+       */
+      {
+         registry groups;
+
+         // each group waits for the other to start, so that they overlap however the workers are scheduled
+         std::atomic<int> started{0};
+         auto const overlap = [&started] { for(++started; started < 2;) std::this_thread::yield(); };
+
+         groups.add([&overlap] { overlap(); std::this_thread::sleep_for(std::chrono::milliseconds(20)); return test::result{"sleeps"}; });
+         groups.add([&overlap]
+         {
+            overlap();
+
+            // spin instead of sleeping, so that the time is spent on the CPU
+            return test::timed("spins", []
+            {
+               auto const end = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+
+               while(std::chrono::steady_clock::now() < end) {}
+
+               return true;
+            });
+         });
+
+         auto const start = std::chrono::steady_clock::now();
+         auto const merged = groups.run("groups", 2);
+         double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         // the run, then each group
+         std::vector<metrics> figures;
+         merged.walk([&figures](test::result const &node, std::size_t) { figures.push_back(node.get_metrics()); });
+
+         bool const recorded = figures.size() == 3 && figures[0].recorded && figures[1].recorded && figures[2].recorded;
+
+         result << test::result{"each group is timed", recorded && figures[1].wall_seconds >= 0.02 && figures[2].cpu_seconds > 0};
+         result << test::result
+         {
+            "run wall time is its own, CPU time is the groups' total",
+            recorded && figures[0].wall_seconds >= std::max(figures[1].wall_seconds, figures[2].wall_seconds) && figures[0].wall_seconds <= elapsed &&
+            figures[0].cpu_seconds == figures[1].cpu_seconds + figures[2].cpu_seconds
+         };
+         result << test::result{"to_string() shows the figures", merged.to_string().find("[success] .. sleeps (wall ") != std::string::npos};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef RUNNER_HPP_
+#define RUNNER_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::function
+#include <functional>
+
+// std::string
+#include <string>
+
+// std::vector
+#include <vector>
+
+// mdt::test::result
+#include "results.hpp"
+
+namespace mdt { namespace test
+{
+   /**
+    * Ordered list of independent test groups which can be run concurrently. Each group builds its own result tree on whichever worker runs it,
+    * and the trees are merged under a common parent in registration order, so the output does not depend on scheduling.
+    */
+   class registry
+   {
+      // a test group: runs its tests and returns their results
+      public: typedef std::function<result()> group_type;
+
+      // called with the results of each group as soon as it and every group registered before it have completed
+      public: typedef std::function<void(result const &group)> completion_type;
+
+      // add a group to be run after those already added
+      public: void add(group_type group);
+
+      // run every group on up to 'jobs' threads (on the calling thread if 'jobs' is 0 or 1) and return their results as children of a new result;
+      // if given, 'on_complete' is called with each group's results in registration order, one call at a time, while the other groups still run,
+      // and each group is released once it has been passed on, so the returned result only holds the overall status and figures (no children); the
+      // run's figures are its own wall time and peak RSS growth along with the CPU time and context switches of all its groups added up
+      public: auto run(std::string description, std::size_t jobs = 1, completion_type on_complete = nullptr) const -> result;
+
+      // the groups, in registration order
+      private: std::vector<group_type> groups;
+   };
+}}
+
+namespace mdt { namespace test { namespace runner
+{
+   // run all registry self-tests
+   auto all() -> result;
+}}}
+
+#endif /* RUNNER_HPP_ */
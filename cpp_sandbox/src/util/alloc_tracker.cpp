@@ -0,0 +1,317 @@
+// std::atomic
+#include <atomic>
+
+// std::malloc(), std::free()
+#include <cstdlib>
+
+// std::cerr, std::endl
+#include <iostream>
+
+// std::bad_alloc, std::nothrow_t, std::get_new_handler()
+#include <new>
+
+// mdt::alloc_counts, mdt::expect_no_alloc
+#include "alloc_tracker.hpp"
+
+#if defined(MDT_TRACK_ALLOC) || defined(MDT_SELF_TEST)
+namespace mdt
+{
+   // counts of the calling thread (plain integers, so that no thread_local initialization ever runs inside operator new)
+   static thread_local alloc_counts thread_counts;
+
+   // counts of every thread
+   static std::atomic<std::size_t> total_allocations{0};
+   static std::atomic<std::size_t> total_bytes_allocated{0};
+   static std::atomic<std::size_t> total_deallocations{0};
+   static std::atomic<std::size_t> total_bytes_freed{0};
+
+   // each block starts with its size, padded to keep the memory handed out suitably aligned for any type
+   static constexpr std::size_t HEADER_SIZE = 16;
+
+   // allocate and count a block, returning nullptr if there is no memory
+   static auto tracked_allocate(std::size_t size) noexcept -> void *
+   {
+      void *block = std::malloc(size + HEADER_SIZE);
+
+      if(!block)
+      {
+         return nullptr;
+      }
+
+      *static_cast<std::size_t *>(block) = size;
+
+      ++thread_counts.allocations;
+      thread_counts.bytes_allocated += size;
+
+      total_allocations.fetch_add(1, std::memory_order_relaxed);
+      total_bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+
+      return static_cast<char *>(block) + HEADER_SIZE;
+   }
+
+   // allocate and count a block, calling the new-handler until there is memory and throwing std::bad_alloc if there is no new-handler
+   static auto tracked_allocate_or_throw(std::size_t size) -> void *
+   {
+      while(true)
+      {
+         if(void *memory = tracked_allocate(size))
+         {
+            return memory;
+         }
+
+         std::new_handler const handler = std::get_new_handler();
+
+         if(!handler)
+         {
+            throw std::bad_alloc();
+         }
+
+         handler();
+      }
+   }
+
+   // count and free a block allocated by tracked_allocate()
+   static void tracked_free(void *memory) noexcept
+   {
+      if(!memory)
+      {
+         return;
+      }
+
+      void *block = static_cast<char *>(memory) - HEADER_SIZE;
+      std::size_t const size = *static_cast<std::size_t *>(block);
+
+      ++thread_counts.deallocations;
+      thread_counts.bytes_freed += size;
+
+      total_deallocations.fetch_add(1, std::memory_order_relaxed);
+      total_bytes_freed.fetch_add(size, std::memory_order_relaxed);
+
+      std::free(block);
+   }
+
+   auto thread_alloc_counts() -> alloc_counts
+   {
+      return thread_counts;
+   }
+
+   auto global_alloc_counts() -> alloc_counts
+   {
+      return {total_allocations.load(std::memory_order_relaxed), total_bytes_allocated.load(std::memory_order_relaxed),
+              total_deallocations.load(std::memory_order_relaxed), total_bytes_freed.load(std::memory_order_relaxed)};
+   }
+}
+
+// the replaceable global allocation and deallocation functions (the sized and aligned forms added after C++11 forward to these by default)
+auto operator new(std::size_t size) -> void * { return mdt::tracked_allocate_or_throw(size); }
+auto operator new[](std::size_t size) -> void * { return mdt::tracked_allocate_or_throw(size); }
+auto operator new(std::size_t size, std::nothrow_t const &) noexcept -> void * { return mdt::tracked_allocate(size); }
+auto operator new[](std::size_t size, std::nothrow_t const &) noexcept -> void * { return mdt::tracked_allocate(size); }
+void operator delete(void *memory) noexcept { mdt::tracked_free(memory); }
+void operator delete[](void *memory) noexcept { mdt::tracked_free(memory); }
+void operator delete(void *memory, std::nothrow_t const &) noexcept { mdt::tracked_free(memory); }
+void operator delete[](void *memory, std::nothrow_t const &) noexcept { mdt::tracked_free(memory); }
+
+#else
+namespace mdt
+{
+   auto thread_alloc_counts() -> alloc_counts
+   {
+      return {0, 0, 0, 0};
+   }
+
+   auto global_alloc_counts() -> alloc_counts
+   {
+      return {0, 0, 0, 0};
+   }
+}
+#endif
+
+namespace mdt
+{
+   expect_no_alloc::expect_no_alloc(char const *where)
+      :
+      where{where},
+      handler{nullptr},
+      start(thread_alloc_counts())
+   {}
+
+   expect_no_alloc::expect_no_alloc(handler_type handler)
+      :
+      where{nullptr},
+      handler{std::move(handler)},
+      start(thread_alloc_counts())
+   {}
+
+   expect_no_alloc::~expect_no_alloc()
+   {
+      alloc_counts const made = counts();
+
+      if(!made.allocations)
+      {
+         return;
+      }
+
+      if(handler)
+      {
+         handler(made);
+      }
+      else
+      {
+         std::cerr << "expect_no_alloc: " << where << ": " << made.allocations << " allocation(s) of " << made.bytes_allocated << " byte(s)" << std::endl;
+      }
+   }
+
+   auto expect_no_alloc::counts() const -> alloc_counts
+   {
+      return thread_alloc_counts() - start;
+   }
+}
+
+#ifdef MDT_SELF_TEST
+
+// std::string
+#include <string>
+
+// mdt::defer
+#include "defer.hpp"
+
+// mdt::pending_queue
+#include "pending_queue.hpp"
+
+// string helper functions
+#include "string.hpp"
+
+namespace mdt { namespace test { namespace alloc_tracker
+{
+   auto all() -> result
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
+
+      test::result result{"alloc_tracker tests"};
+
+      /**
+       * (1) Ensure that allocations and deallocations are counted, with their sizes, for the thread and for the process.
+       */
+      {
+         auto const thread_before = mdt::thread_alloc_counts();
+         auto const global_before = mdt::global_alloc_counts();
+
+         // volatile, so that the compiler cannot elide the pair
+         char *volatile memory = new char[100];
+         delete[] memory;
+
+         auto const thread = mdt::thread_alloc_counts() - thread_before;
+         auto const global = mdt::global_alloc_counts() - global_before;
+
+         result << test::result
+         {
+            "new[] + delete[] -> counted",
+            thread.allocations == 1 && thread.bytes_allocated == 100 && thread.deallocations == 1 && thread.bytes_freed == 100 &&
+            global.allocations >= 1 && global.bytes_allocated >= 100
+         };
+
+         bool reported = false;
+         std::size_t bytes = 0;
+
+         {
+            mdt::expect_no_alloc guard{[&](mdt::alloc_counts const &counts){ reported = true; bytes = counts.bytes_allocated; }};
+
+            std::string const allocates(200, 'x');
+         }
+
+         result << test::result{"allocation inside a guard -> reported", reported && bytes > 200};
+      }
+
+      /**
+       * (2) Ensure that appending to a string which has enough capacity does not allocate.
+       */
+      {
+         std::string s;
+         s.reserve(256);
+
+         std::string const name{"latency"};
+         bool clean = true;
+
+         {
+            mdt::expect_no_alloc guard{[&clean](mdt::alloc_counts const &){ clean = false; }};
+
+            s << name << '=' << 12345 << " ms, ratio " << 0.125 << ", id " << mdt::hex(0xbeefu, 8) << ' ' << mdt::pad(7, 4, '0');
+            mdt::append(s, " (", mdt::fixed(2.5, 2), ')');
+         }
+
+         result << test::result{"operator<< into a reserved string -> no allocations", clean && s == "latency=12345 ms, ratio 0.125, id 0000beef 0007 (2.50)"};
+      }
+
+      /**
+       * (3) Ensure that creating, moving and running a defer does not allocate.
+       */
+      {
+         int calls = 0;
+         bool clean = true;
+
+         {
+            mdt::expect_no_alloc guard{[&clean](mdt::alloc_counts const &){ clean = false; }};
+
+            mdt::defer first{[&calls]{ ++calls; }};
+            mdt::defer second{std::move(first)};
+         }
+
+         result << test::result{"defer -> no allocations", clean && calls == 1};
+      }
+
+      /**
+       * (4) Ensure that, once warmed up, a pending_queue allocates neither when elements are added nor when they are processed.
+       */
+      {
+         static constexpr int BATCH = 1000;
+
+         int calls = 0;
+         mdt::alloc_counts first{0, 0, 0, 0};
+         mdt::alloc_counts last{0, 0, 0, 0};
+
+         // the consumer side is measured with snapshots of the queue thread's counts, taken from the first to the last call-back of the second batch
+         mdt::pending_queue<int> q([&](int)
+         {
+            auto const now = mdt::thread_alloc_counts();
+
+            if(calls++ == BATCH) first = now;
+
+            last = now;
+         });
+
+         bool clean = true;
+
+         {
+            // start the queue thread
+            local(q.go());
+
+            // the first batch grows the queue to its working depth; the second is measured
+            for(int batch = 0; batch < 2; ++batch)
+            {
+               mdt::expect_no_alloc guard{[&clean, batch](mdt::alloc_counts const &){ clean = clean && !batch; }};
+
+               q.pause();
+
+               for(int i = 0; i < BATCH; ++i)
+               {
+                  q.add(i);
+               }
+
+               q.pause(false);
+               q.sync();
+            }
+
+            // end the queue thread
+         }
+
+         result << test::result{"steady-state pending_queue::add() -> no allocations", clean && calls == 2 * BATCH};
+         result << test::result{"steady-state pending_queue processing -> no allocations", (last - first).allocations == 0};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
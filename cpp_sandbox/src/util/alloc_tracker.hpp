@@ -0,0 +1,93 @@
+#ifndef ALLOC_TRACKER_HPP_
+#define ALLOC_TRACKER_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::function
+#include <functional>
+
+namespace mdt
+{
+   // true if the global operator new and operator delete are replaced by counting versions (when MDT_TRACK_ALLOC or MDT_SELF_TEST is defined)
+#if defined(MDT_TRACK_ALLOC) || defined(MDT_SELF_TEST)
+   constexpr bool alloc_tracking = true;
+#else
+   constexpr bool alloc_tracking = false;
+#endif
+
+   /**
+    * Numbers of allocations and deallocations made through the global operator new and operator delete, and their sizes in bytes. Every count
+    * stays at zero unless allocation tracking is enabled.
+    */
+   struct alloc_counts
+   {
+      std::size_t allocations;
+      std::size_t bytes_allocated;
+      std::size_t deallocations;
+      std::size_t bytes_freed;
+
+      // return the counts made between 'earlier' and this snapshot
+      auto operator-(alloc_counts const &earlier) const -> alloc_counts
+      {
+         return {allocations - earlier.allocations, bytes_allocated - earlier.bytes_allocated, deallocations - earlier.deallocations,
+                 bytes_freed - earlier.bytes_freed};
+      }
+   };
+
+   // return the counts of the calling thread since it started
+   auto thread_alloc_counts() -> alloc_counts;
+
+   // return the counts of every thread since the process started
+   auto global_alloc_counts() -> alloc_counts;
+
+   /**
+    * Scoped guard which checks that the calling thread does not allocate while the guard exists. If it did, the counts are reported when the
+    * guard is destroyed: by default to standard error, otherwise to the given handler (e.g., one which records a test failure or aborts).
+    * Allocations made by other threads are not counted. Without allocation tracking, nothing is ever reported.
+    */
+   class expect_no_alloc
+   {
+      // receives the counts of a guard whose thread allocated
+      public: typedef std::function<void(alloc_counts const &counts)> handler_type;
+
+      // report allocations to standard error, naming 'where' (a string which must outlive the guard)
+      public: explicit expect_no_alloc(char const *where);
+
+      // report allocations to the handler
+      public: explicit expect_no_alloc(handler_type handler);
+
+      // disable copy via constructor operator
+      public: expect_no_alloc(expect_no_alloc const &) = delete;
+
+      // disable copy via assignment operator
+      public: expect_no_alloc & operator=(expect_no_alloc const &) = delete;
+
+      // report any allocations made since construction
+      public: ~expect_no_alloc();
+
+      // return the counts of the calling thread since construction
+      public: auto counts() const -> alloc_counts;
+
+      // description used in the default report
+      private: char const *where;
+
+      // handler used instead of the default report, if any
+      private: handler_type handler;
+
+      // the thread's counts when the guard was created
+      private: alloc_counts start;
+   };
+}
+
+#ifdef MDT_SELF_TEST
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace alloc_tracker
+{
+   // run all allocation tracker tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* ALLOC_TRACKER_HPP_ */
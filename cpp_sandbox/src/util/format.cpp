@@ -0,0 +1,67 @@
+#ifdef MDT_SELF_TEST
+
+// std::string
+#include <string>
+
+// mdt::format(), mdt::format_to()
+#include "format.hpp"
+
+// mdt::interned_string
+#include "interned_string.hpp"
+
+namespace mdt { namespace test { namespace format
+{
+   // patterns at namespace scope can be shared by every call site
+   MDT_FORMAT_PATTERN(took, "user {} took {}ms");
+
+   // checked at compile time: a pattern's placeholders and literal length are constant expressions
+   static_assert(mdt::format_placeholders(took::get()) == 2 && mdt::format_literal<took>::length == 13, "took");
+   static_assert(!mdt::format_is_valid("{") && !mdt::format_is_valid("}") && !mdt::format_is_valid("{x}") && mdt::format_is_valid("{}{}"), "braces");
+
+   auto all() -> result
+   {
+      test::result result{"format tests"};
+
+      /**
+       * (1) Ensure that placeholders are replaced in order by arguments of any supported type.
+       */
+      {
+         result << test::result{"format() with a namespace-scope pattern", mdt::format<took>("alice", 42) == "user alice took 42ms"};
+         result << test::result
+         {
+            "format() with mixed argument types",
+            mdt::format<took>(mdt::interned_string{"bob"}, mdt::fixed(1.25, 1)) == "user bob took 1.3ms" &&
+            mdt::format<took>(std::string("eve"), mdt::hex(255)) == "user eve took ffms"
+         };
+      }
+
+      /**
+       * (2) Ensure that patterns without literal text, or without placeholders, are handled.
+       */
+      {
+         MDT_FORMAT_PATTERN(adjacent, "{}{}{}");
+         MDT_FORMAT_PATTERN(plain, "no placeholders");
+         MDT_FORMAT_PATTERN(empty, "");
+
+         result << test::result{"adjacent placeholders", mdt::format<adjacent>('a', 1, "c") == "a1c"};
+         result << test::result{"pattern without placeholders", mdt::format<plain>() == "no placeholders" && mdt::format<empty>().empty()};
+      }
+
+      /**
+       * (3) Ensure that format_to() and MDT_FORMAT_TO() append to an existing string.
+       */
+      {
+         std::string line{"> "};
+
+         mdt::format_to<took>(line, "carol", 7);
+         MDT_FORMAT_TO(line, " [{}/{}]", 1, 2);
+         MDT_FORMAT_TO(line, " done");
+
+         result << test::result{"format_to() appends", line == "> user carol took 7ms [1/2] done"};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
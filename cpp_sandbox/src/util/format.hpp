@@ -0,0 +1,203 @@
+#ifndef FORMAT_HPP_
+#define FORMAT_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::memcpy()
+#include <cstring>
+
+// std::string
+#include <string>
+
+// std::true_type, std::false_type, std::decay()
+#include <type_traits>
+
+// mdt::str_piece
+#include "string.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                Public Macros                                                                  ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// declare a type named 'name' which carries the string literal 'pattern' to mdt::format() and mdt::format_to() at compile time
+#define MDT_FORMAT_PATTERN(name, pattern) struct name { static constexpr auto get() -> char const * { return pattern; } }
+
+// append 'pattern' (a string literal, which must come first) with its {} placeholders replaced by the remaining arguments, if any, to the
+// std::string 'output'; the pattern travels with the arguments so that a pattern without placeholders needs no arguments
+#define MDT_FORMAT_TO(output, ...) \
+   do \
+   { \
+      MDT_FORMAT_PATTERN(mdt_format_pattern_, MDT_FORMAT_FIRST_(__VA_ARGS__, ~)); \
+      mdt::format_to_after_pattern<mdt_format_pattern_>(output, __VA_ARGS__); \
+   } while(false)
+
+// for internal use: expand to the first argument
+#define MDT_FORMAT_FIRST_(first, ...) first
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                          Compile-Time Pattern Parsing                                                         ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   // return true if every brace in the pattern belongs to a {} placeholder
+   constexpr auto format_is_valid(char const *p) -> bool
+   {
+      return !*p ? true : *p == '{' ? (p[1] == '}' && format_is_valid(p + 2)) : *p == '}' ? false : format_is_valid(p + 1);
+   }
+
+   // return the number of {} placeholders in the pattern
+   constexpr auto format_placeholders(char const *p) -> std::size_t
+   {
+      return !*p ? 0 : (p[0] == '{' && p[1] == '}') ? 1 + format_placeholders(p + 2) : format_placeholders(p + 1);
+   }
+
+   // return the number of characters in the pattern which are copied as they are (i.e., excluding placeholders)
+   constexpr auto format_literal_length(char const *p) -> std::size_t
+   {
+      return !*p ? 0 : (p[0] == '{' && p[1] == '}') ? format_literal_length(p + 2) : 1 + format_literal_length(p + 1);
+   }
+
+   // return the offset of the literal segment which follows the i-th placeholder (or the first segment, for i = 0)
+   constexpr auto format_segment_begin(char const *p, std::size_t i, std::size_t position = 0) -> std::size_t
+   {
+      return i == 0 ? position : (p[position] == '{' && p[position + 1] == '}') ? format_segment_begin(p, i - 1, position + 2)
+                                                                               : format_segment_begin(p, i, position + 1);
+   }
+
+   // return the offset just past the literal segment which starts at 'position'
+   constexpr auto format_segment_end(char const *p, std::size_t position) -> std::size_t
+   {
+      return (!p[position] || p[position] == '{') ? position : format_segment_end(p, position + 1);
+   }
+
+   // the bounds of the literal segment following the I-th placeholder, resolved at compile time
+   template<class Pattern, std::size_t I>
+   struct format_segment
+   {
+      static constexpr std::size_t begin = format_segment_begin(Pattern::get(), I);
+      static constexpr std::size_t length = format_segment_end(Pattern::get(), begin) - begin;
+   };
+
+   // the number of characters of the pattern which are copied as they are, resolved at compile time
+   template<class Pattern>
+   struct format_literal
+   {
+      static constexpr std::size_t length = format_literal_length(Pattern::get());
+   };
+
+   // provides 'value' as true if every one of Ts... has a str_piece specialization
+   template<typename... Ts> struct is_formattable;
+
+   template<> struct is_formattable<> : std::true_type {};
+
+   template<typename T, typename... Ts> struct is_formattable<T, Ts...>
+   {
+      private: template<typename U> static auto test(int) -> decltype(sizeof(str_piece<U>), std::true_type());
+      private: template<typename U> static auto test(long) -> std::false_type;
+
+      public: static constexpr bool value = decltype(test<typename std::decay<T const>::type>(0))::value && is_formattable<Ts...>::value;
+   };
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Formatting                                                                   ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   // for internal use: return the total size of the pieces
+   inline auto format_pieces_size() -> std::size_t
+   {
+      return 0;
+   }
+
+   // for internal use: return the total size of the pieces
+   template<typename Piece, typename... Pieces>
+   auto format_pieces_size(Piece const &piece, Pieces const &... pieces) -> std::size_t
+   {
+      return piece.size() + format_pieces_size(pieces...);
+   }
+
+   // for internal use: copy the final literal segment
+   template<class Pattern, std::size_t I>
+   void format_write(char *out)
+   {
+      std::memcpy(out, Pattern::get() + format_segment<Pattern, I>::begin, format_segment<Pattern, I>::length);
+   }
+
+   // for internal use: copy the I-th literal segment, then write the piece which replaces the placeholder after it, and so on
+   template<class Pattern, std::size_t I, typename Piece, typename... Pieces>
+   void format_write(char *out, Piece const &piece, Pieces const &... pieces)
+   {
+      std::memcpy(out, Pattern::get() + format_segment<Pattern, I>::begin, format_segment<Pattern, I>::length);
+
+      format_write<Pattern, I + 1>(piece.write(out + format_segment<Pattern, I>::length), pieces...);
+   }
+
+   // for internal use: size the string once for the literal text and every piece, then write them in place
+   template<class Pattern, typename... Pieces>
+   void format_pieces(std::string &s, Pieces const &... pieces)
+   {
+      std::size_t const offset = s.size();
+
+      s.resize(offset + format_literal<Pattern>::length + format_pieces_size(pieces...));
+
+      format_write<Pattern, 0>(&s[offset], pieces...);
+   }
+
+   /**
+    * Append the pattern to 's' with each {} placeholder replaced by the next argument. The pattern is a type declared with MDT_FORMAT_PATTERN(),
+    * so it is parsed and checked against the arguments at compile time; at run time only the literal segments (with lengths known at compile
+    * time) and the arguments are copied, after a single resize of 's'.
+    */
+   template<class Pattern, typename... Ts>
+   auto format_to(std::string &s, Ts const &... ts) -> std::string &
+   {
+      static_assert(format_is_valid(Pattern::get()), "format pattern contains a brace which is not part of a {} placeholder");
+      static_assert(format_placeholders(Pattern::get()) == sizeof...(Ts), "format pattern placeholder count differs from the argument count");
+      static_assert(is_formattable<Ts...>::value, "format argument type is not supported by mdt::str_piece");
+
+      format_pieces<Pattern>(s, str_piece<typename std::decay<Ts const>::type>(ts)...);
+
+      return s;
+   }
+
+   // for internal use by MDT_FORMAT_TO(): format_to(), skipping the pattern literal which the macro passes ahead of the arguments
+   template<class Pattern, typename... Ts>
+   auto format_to_after_pattern(std::string &s, char const *, Ts const &... ts) -> std::string &
+   {
+      return format_to<Pattern>(s, ts...);
+   }
+
+   // return the pattern with each {} placeholder replaced by the next argument; see format_to()
+   template<class Pattern, typename... Ts>
+   auto format(Ts const &... ts) -> std::string
+   {
+      std::string s;
+      format_to<Pattern>(s, ts...);
+      return s;
+   }
+}
+
+#ifdef MDT_SELF_TEST
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace format
+{
+   // run all format tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* FORMAT_HPP_ */
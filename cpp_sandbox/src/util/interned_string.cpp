@@ -0,0 +1,235 @@
+// uint64_t
+#include <cstdint>
+
+// std::memcmp(), std::strlen()
+#include <cstring>
+
+// std::deque
+#include <deque>
+
+// std::numeric_limits
+#include <limits>
+
+// std::mutex, std::lock_guard
+#include <mutex>
+
+// std::unordered_map
+#include <unordered_map>
+
+// mdt::interned_string
+#include "interned_string.hpp"
+
+namespace mdt
+{
+   // characters being looked up, together with their hash so that it is computed only once per lookup
+   struct intern_key
+   {
+      char const *data;
+      std::size_t length;
+      std::size_t hash;
+
+      auto operator==(intern_key const &other) const -> bool
+      {
+         return length == other.length && !std::memcmp(data, other.data, length);
+      }
+   };
+
+   // hands the precomputed hash to the table
+   struct intern_key_hash
+   {
+      auto operator()(intern_key const &key) const -> std::size_t { return key.hash; }
+   };
+
+   // one independently-locked part of the intern table
+   struct intern_shard
+   {
+      // makes 'entries' and 'strings' thread-safe
+      std::mutex lock;
+
+      // maps the characters of each entry (pointing into 'strings') to the entry itself
+      std::unordered_map<intern_key, std::string const *, intern_key_hash> entries;
+
+      // owns the entries; a deque never moves its elements as it grows
+      std::deque<std::string> strings;
+   };
+
+   // number of bits of the hash which pick the shard
+   static constexpr unsigned SHARD_BITS = 6;
+
+   // number of shards; a power of two so that the shard can be picked with a shift
+   static constexpr std::size_t SHARD_COUNT = std::size_t{1} << SHARD_BITS;
+
+   // return the process-wide table (created on first use, so interning works during static initialization too)
+   static auto shards() -> intern_shard *
+   {
+      static intern_shard table[SHARD_COUNT];
+      return table;
+   }
+
+   // 64-bit FNV-1a hash of the characters
+   static auto hash_bytes(char const *data, std::size_t length) -> std::size_t
+   {
+      uint64_t hash = 14695981039346656037ull;
+
+      for(std::size_t i = 0; i < length; ++i)
+      {
+         hash ^= static_cast<unsigned char>(data[i]);
+         hash *= 1099511628211ull;
+      }
+
+      return static_cast<std::size_t>(hash ^ (hash >> 32));
+   }
+
+   // return the entry equal to the characters, adding one if none exists
+   static auto intern(char const *data, std::size_t length) -> std::string const *
+   {
+      intern_key key{data, length, hash_bytes(data, length)};
+
+      // the top bits pick the shard, leaving the low bits (used by the shard's buckets) independent of the choice
+      intern_shard &shard = shards()[key.hash >> (std::numeric_limits<std::size_t>::digits - SHARD_BITS)];
+
+      std::lock_guard<std::mutex> lock{shard.lock};
+
+      auto const found = shard.entries.find(key);
+
+      if(found != shard.entries.end())
+      {
+         return found->second;
+      }
+
+      // copy the characters into the shard, then point the key at the copy
+      shard.strings.emplace_back(data, length);
+      std::string const *entry = &shard.strings.back();
+
+      key.data = entry->data();
+      shard.entries.emplace(key, entry);
+
+      return entry;
+   }
+
+   interned_string::interned_string()
+      :
+      value{intern("", 0)}
+   {}
+
+   interned_string::interned_string(std::string const &value)
+      :
+      value{intern(value.data(), value.size())}
+   {}
+
+   interned_string::interned_string(char const *value)
+      :
+      value{intern(value, std::strlen(value))}
+   {}
+
+   interned_string::interned_string(char const *data, std::size_t length)
+      :
+      value{intern(data, length)}
+   {}
+}
+
+#ifdef MDT_SELF_TEST
+
+// std::atomic
+#include <atomic>
+
+// std::thread
+#include <thread>
+
+// std::unordered_set
+#include <unordered_set>
+
+// std::vector
+#include <vector>
+
+// mdt::pending_queue
+#include "pending_queue.hpp"
+
+namespace mdt { namespace test { namespace interned_string
+{
+   auto all() -> result
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
+
+      test::result result{"interned_string tests"};
+
+      /**
+       * (1) Ensure that equal strings intern to the same entry and different strings to different entries.
+       */
+      {
+         std::string const name{"requests.total"};
+
+         mdt::interned_string const a{name};
+         mdt::interned_string const b{"requests.total"};
+         mdt::interned_string const c{"requests.failed"};
+
+         result << test::result{"equal strings -> same entry", a == b && &a.str() == &b.str() && a.str() == name};
+         result << test::result{"different strings -> different entries", a != c && c.str() == "requests.failed"};
+         result << test::result{"default construction = empty string", mdt::interned_string().empty() && mdt::interned_string() == mdt::interned_string("")};
+         result << test::result{"embedded null characters", mdt::interned_string("a\0b", 3).size() == 3 && mdt::interned_string("a\0b", 3) != mdt::interned_string("a")};
+      }
+
+      /**
+       * (2) Ensure that threads interning the same strings concurrently all receive the same entries.
+       */
+      {
+         std::vector<std::vector<mdt::interned_string>> interned(4);
+         std::vector<std::thread> threads;
+
+         for(auto &output : interned)
+         {
+            threads.emplace_back([&output]
+            {
+               for(int i = 0; i < 2000; ++i)
+               {
+                  output.push_back(mdt::interned_string{mdt::concat("tenant-", i % 500)});
+               }
+            });
+         }
+
+         for(auto &thread : threads) thread.join();
+
+         bool consistent = true;
+
+         for(auto const &output : interned)
+         {
+            consistent = consistent && output == interned[0];
+         }
+
+         std::unordered_set<mdt::interned_string> const distinct(interned[0].begin(), interned[0].end());
+
+         result << test::result{"concurrent interning -> same entries", consistent && distinct.size() == 500};
+      }
+
+      /**
+       * (3) Ensure that interned strings can be appended and passed through a pending_queue.
+       */
+      {
+         mdt::interned_string const key{"latency"};
+
+         std::string line;
+         line << key << '=' << 12;
+
+         std::vector<mdt::interned_string> output;
+         mdt::pending_queue<mdt::interned_string> q([&](mdt::interned_string s){output.push_back(s);});
+
+         {
+            // start the queue thread
+            local(q.go());
+
+            q.add(key);
+            q.add(mdt::interned_string{"latency"});
+
+            // end the queue thread
+         }
+
+         result << test::result{"operator<< appends the characters", line == "latency=12" && mdt::concat(key, '!') == "latency!"};
+         result << test::result{"pending_queue carries handles", output.size() == 2 && output[0] == key && output[1] == key};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
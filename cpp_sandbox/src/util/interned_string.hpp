@@ -0,0 +1,96 @@
+#ifndef INTERNED_STRING_HPP_
+#define INTERNED_STRING_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::hash
+#include <functional>
+
+// std::string
+#include <string>
+
+// mdt::str_piece
+#include "string.hpp"
+
+namespace mdt
+{
+   /**
+    * Handle to an immutable string stored once in a process-wide intern table. Handles are a single pointer, so they are cheap to copy and move,
+    * and two handles are equal exactly when they point at the same entry. Interning is a lookup-or-insert in one of several independently-locked
+    * shards of the table, so threads interning different strings rarely contend. Interned strings live until the process exits.
+    */
+   class interned_string
+   {
+      // refer to the empty string
+      public: interned_string();
+
+      // refer to the table entry equal to 'value', adding one if none exists
+      public: explicit interned_string(std::string const &value);
+
+      // refer to the table entry equal to the C-string 'value', adding one if none exists
+      public: explicit interned_string(char const *value);
+
+      // refer to the table entry equal to the 'length' bytes at 'data', adding one if none exists
+      public: interned_string(char const *data, std::size_t length);
+
+      // return the interned string
+      public: auto str() const -> std::string const & { return *value; }
+
+      // return the interned string as a C-string
+      public: auto c_str() const -> char const * { return value->c_str(); }
+
+      // return the length of the interned string
+      public: auto size() const -> std::size_t { return value->size(); }
+
+      // return true if this refers to the empty string
+      public: auto empty() const -> bool { return value->empty(); }
+
+      // allow the handle to be used wherever a std::string is read
+      public: operator std::string const &() const { return *value; }
+
+      // two handles are equal exactly when they refer to the same entry
+      public: auto operator==(interned_string const &other) const -> bool { return value == other.value; }
+
+      // two handles are equal exactly when they refer to the same entry
+      public: auto operator!=(interned_string const &other) const -> bool { return value != other.value; }
+
+      // order handles by entry (not alphabetically), which is consistent for the lifetime of the process
+      public: auto operator<(interned_string const &other) const -> bool { return std::less<std::string const *>()(value, other.value); }
+
+      // return a hash of the entry (not of its characters)
+      public: auto hash() const -> std::size_t { return std::hash<std::string const *>()(value); }
+
+      // the table entry
+      private: std::string const *value;
+   };
+
+   // interned strings are copied directly from their table entry
+   template<>
+   class str_piece<interned_string> : public str_piece<std::string>
+   {
+      public: explicit str_piece(interned_string const &t) : str_piece<std::string>(t.str()) {}
+   };
+}
+
+namespace std
+{
+   // allow interned strings as keys of unordered containers
+   template<>
+   struct hash<mdt::interned_string>
+   {
+      auto operator()(mdt::interned_string const &s) const -> std::size_t { return s.hash(); }
+   };
+}
+
+#ifdef MDT_SELF_TEST
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace interned_string
+{
+   // run all interned string tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* INTERNED_STRING_HPP_ */
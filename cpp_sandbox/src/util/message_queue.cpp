@@ -0,0 +1,182 @@
+#ifdef MDT_SELF_TEST
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// std::unique_ptr
+#include <memory>
+
+// std::string
+#include <string>
+
+// std::vector
+#include <vector>
+
+// mdt::message_queue
+#include "message_queue.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// message tests ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt { namespace test { namespace message_queue { namespace messages
+{
+   // counts live instances so that the tests can check that every held value is destroyed exactly once
+   struct counted
+   {
+      counted(int &live) : live(&live) { ++*this->live; }
+      counted(counted const &other) : live(other.live) { ++*live; }
+      ~counted() { --*live; }
+
+      int *live;
+   };
+
+   static auto all() -> test::result
+   {
+      test::result result("message tests");
+
+      typedef mdt::message<int, std::string, counted> message_type;
+
+      /**
+       ** (1) Ensure that a message reports the type of the value it holds.
+       **/
+      {
+         message_type empty;
+         message_type number{42};
+         message_type text{std::string("text")};
+
+         result << test::result{"default construction = empty message", empty.index() == message_type::npos};
+         result << test::result{"construction from int = holds int", number.holds<int>() && number.get<int>() == 42};
+         result << test::result{"construction from std::string = holds std::string", text.holds<std::string>() && text.get<std::string>() == "text"};
+      }
+
+      /**
+       ** (2) Ensure that copies, moves, assignments and destruction construct and destroy the held value exactly once each.
+       **/
+      {
+         int live = 0;
+
+         {
+            message_type a{counted{live}};
+            message_type b{a};
+            message_type c{std::move(b)};
+
+            // replacing a held value must destroy it
+            a = message_type{1};
+            c = a;
+         }
+
+         result << test::result{"copy -> move -> assign -> destroy = no leaked values", live == 0};
+      }
+
+      /**
+       ** (3) Ensure that a message holding a move-only alternative cannot be copied, moves without throwing, and can be kept in a std::vector.
+       **/
+      {
+         typedef mdt::message<int, std::unique_ptr<int>> move_only;
+
+         static_assert(!std::is_copy_constructible<move_only>::value && !std::is_copy_assignable<move_only>::value, "move-only message is copyable");
+         static_assert(std::is_nothrow_move_constructible<move_only>::value, "move-only message may throw when moved");
+         static_assert(std::is_nothrow_move_assignable<move_only>::value, "move-only message may throw when move-assigned");
+         static_assert(std::is_copy_constructible<message_type>::value, "copyable message is not copyable");
+
+         std::vector<move_only> messages;
+
+         for(int i = 0; i < 10; ++i)
+         {
+            messages.emplace_back(std::unique_ptr<int>(new int(i)));
+         }
+
+         result << test::result{"std::vector of move-only messages", messages.size() == 10 && *messages[9].get<std::unique_ptr<int>>() == 9};
+      }
+
+      return result;
+   }
+}}}}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// message_queue tests ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt { namespace test { namespace message_queue { namespace queues
+{
+   // records which overload each message was dispatched to
+   struct recorder
+   {
+      void operator()(int i) { output->push_back("int " + std::to_string(i)); }
+      void operator()(std::string s) { output->push_back("string " + s); }
+      void operator()(std::unique_ptr<double> d) { output->push_back("pointer " + std::to_string(static_cast<int>(*d))); }
+
+      std::vector<std::string> *output;
+   };
+
+   static auto all() -> test::result
+   {
+      test::result result("message_queue tests");
+
+      std::vector<std::string> output;
+
+      mdt::message_queue<int, std::string, std::unique_ptr<double>> q(recorder{&output});
+
+      /**
+       ** (1) Ensure that mixed messages are dispatched in order to the overload matching their type, including move-only types.
+       **/
+      {
+         // start the queue thread
+         local(q.go());
+
+         q.add(1);
+         q.add(std::string("two"));
+         q.add(std::unique_ptr<double>(new double(3)));
+         q.add(4);
+
+         q.sync();
+
+         // end the queue thread
+      }
+
+      std::vector<std::string> const expected{"int 1", "string two", "pointer 3", "int 4"};
+
+      result << test::result{"mixed add -> sync = dispatched by type in order", output == expected};
+
+      /**
+       ** (2) Ensure that stopped queues throw back the inserted message.
+       **/
+      try
+      {
+         q.add(std::string("late"));
+
+         result << test::result{"adding to a stopped queue should have thrown an exception", false};
+      }
+      catch(decltype(q)::element_type const &e)
+      {
+         result << test::result{"adding to a stopped queue should throw the message", e.holds<std::string>() && e.get<std::string>() == "late"};
+      }
+      catch(...)
+      {
+         result << test::result{"caught wrong exception type (should be 'element_type')", false};
+      }
+
+      return result;
+   }
+}}}}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// test interface ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt { namespace test { namespace message_queue
+{
+   // run all message queue tests
+   auto all() -> result
+   {
+      return result{"message_queue tests"} << messages::all() << queues::all();
+   }
+}}}
+
+#endif
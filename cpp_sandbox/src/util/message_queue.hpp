@@ -0,0 +1,364 @@
+#ifndef MESSAGE_QUEUE_HPP_
+#define MESSAGE_QUEUE_HPP_
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// assert()
+#include <cassert>
+
+// std::size_t
+#include <cstddef>
+
+// placement new
+#include <new>
+
+// std::aligned_storage(), std::enable_if(), std::decay(), std::integral_constant(), std::conditional(), std::is_copy_constructible()
+#include <type_traits>
+
+// std::move(), std::forward()
+#include <utility>
+
+// mdt::pending_queue()
+#include "pending_queue.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                             message Definition                                                                ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   // provides 'value' as the position of T within Ts..., or sizeof...(Ts) if T is not one of them
+   template<class T, class... Ts> struct type_index;
+
+   template<class T> struct type_index<T> : std::integral_constant<std::size_t, 0> {};
+
+   template<class T, class... Ts> struct type_index<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+   template<class T, class U, class... Ts> struct type_index<T, U, Ts...>
+      : std::integral_constant<std::size_t, 1 + type_index<T, Ts...>::value> {};
+
+   // provides 'value' as the largest of the given sizes
+   template<std::size_t... Sizes> struct max_size;
+
+   template<> struct max_size<> : std::integral_constant<std::size_t, 1> {};
+
+   template<std::size_t Size, std::size_t... Sizes> struct max_size<Size, Sizes...>
+      : std::integral_constant<std::size_t, (Size > max_size<Sizes...>::value ? Size : max_size<Sizes...>::value)> {};
+
+   // provides 'value' as true if every one of the given conditions is true
+   template<bool... Conditions> struct all_of;
+
+   template<> struct all_of<> : std::true_type {};
+
+   template<bool Condition, bool... Conditions> struct all_of<Condition, Conditions...>
+      : std::integral_constant<bool, Condition && all_of<Conditions...>::value> {};
+
+   /**
+    * Tagged union holding exactly one value of one of the types Ts... (or nothing, when default-constructed or moved-from). The value is stored
+    * inline and every type-dependent operation goes through a table of functions indexed by the stored type, so no heap allocation and no virtual
+    * call is involved.
+    */
+   template<class... Ts>
+   class message
+   {
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Type Definitions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // the type of this templated class, provided for cases in which the type is difficult to deduce
+      public: typedef message<Ts...> class_type;
+
+      // the index reported by index() when no value is held
+      public: static constexpr std::size_t npos = sizeof...(Ts);
+
+      // true if every one of Ts... can be copied, in which case messages can be copied too
+      public: static constexpr bool copyable = all_of<std::is_copy_constructible<Ts>::value...>::value;
+
+      // true if every one of Ts... can be moved without throwing, in which case messages can be too (so containers move rather than copy them)
+      public: static constexpr bool nothrow_movable = all_of<std::is_nothrow_move_constructible<Ts>::value...>::value;
+
+      // parameter type of the copy operations: the message itself if it is copyable, otherwise a type which no caller can name, which leaves
+      // the message's copy operations implicitly deleted (instead of failing to compile when they are instantiated)
+      private: struct not_copyable {};
+      private: typedef typename std::conditional<copyable, class_type, not_copyable>::type copy_source;
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Functions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // create an empty message
+      public: message() : which{npos} {}
+
+      // create a message holding a value of one of the types Ts...
+      public: template<class T, class U = typename std::decay<T>::type, class = typename std::enable_if<type_index<U, Ts...>::value != npos>::type>
+      message(T &&value)
+         :
+         which{type_index<U, Ts...>::value}
+      {
+         new(&storage) U(std::forward<T>(value));
+      }
+
+      // copy the held value, if any
+      public: message(copy_source const &other)
+         :
+         which{other.which}
+      {
+         static void (* const copy[])(void *, void const *) = {&copy_construct<Ts>...};
+
+         if(which != npos) copy[which](&storage, &other.storage);
+      }
+
+      // move the held value, if any; 'other' keeps its (moved-from) value until it is destroyed or re-assigned
+      public: message(class_type &&other) noexcept(nothrow_movable)
+         :
+         which{other.which}
+      {
+         static void (* const move[])(void *, void *) = {&move_construct<Ts>...};
+
+         if(which != npos) move[which](&storage, &other.storage);
+      }
+
+      // replace the held value with a copy of the other message's value
+      public: class_type & operator=(copy_source const &other)
+      {
+         if(this != &other)
+         {
+            reset();
+
+            static void (* const copy[])(void *, void const *) = {&copy_construct<Ts>...};
+
+            if(other.which != npos) copy[other.which](&storage, &other.storage);
+
+            which = other.which;
+         }
+
+         return *this;
+      }
+
+      // replace the held value with the other message's value
+      public: class_type & operator=(class_type &&other) noexcept(nothrow_movable)
+      {
+         if(this != &other)
+         {
+            reset();
+
+            static void (* const move[])(void *, void *) = {&move_construct<Ts>...};
+
+            if(other.which != npos) move[other.which](&storage, &other.storage);
+
+            which = other.which;
+         }
+
+         return *this;
+      }
+
+      // destroy the held value, if any
+      public: ~message()
+      {
+         reset();
+      }
+
+      // return the position within Ts... of the held value's type, or npos if the message is empty
+      public: auto index() const -> std::size_t
+      {
+         return which;
+      }
+
+      // return true if the message holds a value of type T
+      public: template<class T> auto holds() const -> bool
+      {
+         return which == type_index<T, Ts...>::value;
+      }
+
+      // return the held value, which must be of type T
+      public: template<class T> auto get() -> T &
+      {
+         assert(holds<T>());
+
+         return *reinterpret_cast<T *>(&storage);
+      }
+
+      // return the held value, which must be of type T
+      public: template<class T> auto get() const -> T const &
+      {
+         assert(holds<T>());
+
+         return *reinterpret_cast<T const *>(&storage);
+      }
+
+      // move the held value into the overload of 'handler' which accepts its type; the overload is selected at compile time for each of Ts...
+      public: template<class Handler> void visit(Handler &handler)
+      {
+         // one entry per type, so the dispatch is a single indexed call
+         static void (* const call[])(void *, Handler &) = {&invoke<Ts, Handler>...};
+
+         assert(which != npos);
+
+         call[which](&storage, handler);
+      }
+
+      // destroy the held value, if any, leaving the message empty
+      public: void reset()
+      {
+         static void (* const destroy[])(void *) = {&destroy_value<Ts>...};
+
+         if(which != npos)
+         {
+            destroy[which](&storage);
+            which = npos;
+         }
+      }
+
+      // copy-construct a T from 'source' into 'target'
+      private: template<class T> static void copy_construct(void *target, void const *source)
+      {
+         new(target) T(*static_cast<T const *>(source));
+      }
+
+      // move-construct a T from 'source' into 'target'
+      private: template<class T> static void move_construct(void *target, void *source)
+      {
+         new(target) T(std::move(*static_cast<T *>(source)));
+      }
+
+      // destroy the T stored in 'value'
+      private: template<class T> static void destroy_value(void *value)
+      {
+         static_cast<T *>(value)->~T();
+      }
+
+      // hand the T stored in 'value' to the matching overload of 'handler'
+      private: template<class T, class Handler> static void invoke(void *value, Handler &handler)
+      {
+         handler(std::move(*static_cast<T *>(value)));
+      }
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Variables ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // raw storage large enough and aligned enough for any of Ts...
+      private: typename std::aligned_storage<max_size<sizeof(Ts)...>::value, max_size<alignof(Ts)...>::value>::type storage;
+
+      // position within Ts... of the held value's type, or npos if the message is empty
+      private: std::size_t which;
+   };
+
+   template<class... Ts> constexpr std::size_t message<Ts...>::npos;
+   template<class... Ts> constexpr bool message<Ts...>::copyable;
+   template<class... Ts> constexpr bool message<Ts...>::nothrow_movable;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                          message_queue Definition                                                             ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   /**
+    * pending_queue carrying several message types inline. Each processed message is moved into the overload of the handler which accepts its
+    * type, so mixed traffic needs neither a heap allocation per message nor a virtual call.
+    */
+   template<class... Ts>
+   class message_queue
+   {
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Type Definitions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // stored element type, provided for cases in which the type is difficult to deduce
+      public: typedef message<Ts...> element_type;
+
+      // the type of this templated class, provided for cases in which the type is difficult to deduce
+      public: typedef message_queue<Ts...> class_type;
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Functions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // construct a message queue which dispatches every message to the overload set of 'handler' (a function object callable with each of Ts...)
+      public: template<class Handler> message_queue(Handler handler)
+         :
+         queue{[handler](element_type element) mutable { element.visit(handler); }}
+      {}
+
+      // disallow copying via copy constructor
+      public: message_queue(class_type const &) = delete;
+
+      // disallow copying via assignment operator
+      public: class_type & operator=(class_type const &) = delete;
+
+      // move via move constructor
+      public: message_queue(class_type &&) = default;
+
+      // disallow move via assignment operator (because we don't offer an empty constructor)
+      public: class_type & operator=(class_type &&) = delete;
+
+      // empty destructor
+      public: ~message_queue() {}
+
+      // create a 'defer' instance which will stop the queue thread when it goes out of scope
+      public: auto go() -> defer
+      {
+         return queue.go();
+      }
+
+      // wait until all of the currently pending messages have been processed
+      public: void sync()
+      {
+         queue.sync();
+      }
+
+      // pause or un-pause the queue
+      public: void pause(bool pause = true)
+      {
+         queue.pause(pause);
+      }
+
+      // add a message of any of the types Ts... (after the queue has been stopped, the message is thrown back as an element_type)
+      public: template<class T> void add(T &&value)
+      {
+         queue.add(element_type(std::forward<T>(value)));
+      }
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Variables ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // the underlying queue of tagged messages
+      private: pending_queue<element_type> queue;
+   };
+}
+
+#ifdef MDT_SELF_TEST
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                    Self-Tests                                                                 ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// mdt::test::result
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace message_queue
+{
+   // run all message_queue self-tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* MESSAGE_QUEUE_HPP_ */
@@ -0,0 +1,819 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// uint32_t, uint64_t
+#include <cstdint>
+
+// std::memcpy(), std::memset()
+#include <cstring>
+
+// mdt::format_decimal(), mdt::format_shortest(), ...
+#include "number_format.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Integers                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   // every two-digit number, so that integers are written two digits per division
+   static char const DIGIT_PAIRS[] =
+      "00010203040506070809"
+      "10111213141516171819"
+      "20212223242526272829"
+      "30313233343536373839"
+      "40414243444546474849"
+      "50515253545556575859"
+      "60616263646566676869"
+      "70717273747576777879"
+      "80818283848586878889"
+      "90919293949596979899";
+
+   // return the number of decimal digits in 'value' (at least one)
+   static auto count_digits(unsigned long long value) -> unsigned
+   {
+      unsigned digits = 1;
+
+      // test four digits per division
+      while(true)
+      {
+         if(value < 10) return digits;
+         if(value < 100) return digits + 1;
+         if(value < 1000) return digits + 2;
+         if(value < 10000) return digits + 3;
+
+         value /= 10000;
+         digits += 4;
+      }
+   }
+
+   auto format_decimal(char *out, unsigned long long value) -> char *
+   {
+      // the length is known up front, so the digits are written from the least significant end straight into place
+      char *const end = out + count_digits(value);
+      char *position = end;
+
+      while(value >= 100)
+      {
+         auto const pair = static_cast<std::size_t>(value % 100) * 2;
+         value /= 100;
+
+         *--position = DIGIT_PAIRS[pair + 1];
+         *--position = DIGIT_PAIRS[pair];
+      }
+
+      if(value >= 10)
+      {
+         auto const pair = static_cast<std::size_t>(value) * 2;
+
+         *--position = DIGIT_PAIRS[pair + 1];
+         *--position = DIGIT_PAIRS[pair];
+      }
+      else
+      {
+         *--position = static_cast<char>('0' + value);
+      }
+
+      return end;
+   }
+
+   auto format_decimal(char *out, long long value) -> char *
+   {
+      if(value < 0)
+      {
+         *out++ = '-';
+
+         // negate as an unsigned value so that the most negative value does not overflow
+         return format_decimal(out, 0 - static_cast<unsigned long long>(value));
+      }
+
+      return format_decimal(out, static_cast<unsigned long long>(value));
+   }
+
+   auto format_hex(char *out, unsigned long long value, unsigned width) -> char *
+   {
+      static char const DIGITS[] = "0123456789abcdef";
+
+      unsigned length = 1;
+
+      for(unsigned long long rest = value >> 4; rest; rest >>= 4)
+      {
+         ++length;
+      }
+
+      if(length < width)
+      {
+         length = width;
+      }
+
+      char *const end = out + length;
+
+      for(char *position = end; position != out; value >>= 4)
+      {
+         *--position = DIGITS[value & 0xf];
+      }
+
+      return end;
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                               Floating Point                                                                  ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Shortest round-trip digits are generated with Florian Loitsch's Grisu2 algorithm ("Printing Floating-Point Numbers Quickly and Accurately with
+// Integers", PLDI 2010). The output always reads back as the original value; in rare cases it has one more digit than strictly necessary.
+
+namespace mdt
+{
+   // a floating-point value f * 2^e with a 64-bit significand and no implicit bit
+   struct diyfp
+   {
+      uint64_t f;
+      int e;
+   };
+
+   // return x - y; both must have the same exponent and x must not be less than y
+   static auto subtract(diyfp x, diyfp y) -> diyfp
+   {
+      return {x.f - y.f, x.e};
+   }
+
+   // return x * y, rounded to the upper 64 bits of the 128-bit product
+   static auto multiply(diyfp x, diyfp y) -> diyfp
+   {
+      uint64_t const x_lo = x.f & 0xffffffffu;
+      uint64_t const x_hi = x.f >> 32;
+      uint64_t const y_lo = y.f & 0xffffffffu;
+      uint64_t const y_hi = y.f >> 32;
+
+      uint64_t const lo_lo = x_lo * y_lo;
+      uint64_t const lo_hi = x_lo * y_hi;
+      uint64_t const hi_lo = x_hi * y_lo;
+      uint64_t const hi_hi = x_hi * y_hi;
+
+      // sum the middle 32-bit column, rounding the discarded lower half
+      uint64_t const middle = (lo_lo >> 32) + (lo_hi & 0xffffffffu) + (hi_lo & 0xffffffffu) + (uint64_t{1} << 31);
+
+      return {hi_hi + (lo_hi >> 32) + (hi_lo >> 32) + (middle >> 32), x.e + y.e + 64};
+   }
+
+   // shift x left until its most significant bit is set
+   static auto normalize(diyfp x) -> diyfp
+   {
+      while(!(x.f >> 63))
+      {
+         x.f <<= 1;
+         --x.e;
+      }
+
+      return x;
+   }
+
+   // shift x left until its exponent is 'e' (which must not be greater than x's exponent)
+   static auto normalize_to(diyfp x, int e) -> diyfp
+   {
+      return {x.f << (x.e - e), e};
+   }
+
+   // a value together with the (normalized) boundaries of the interval of real numbers which round to it
+   struct boundaries
+   {
+      diyfp minus;
+      diyfp plus;
+   };
+
+   // compute the rounding interval of the positive value with the given biased exponent and stored fraction bits
+   static auto compute_boundaries(uint64_t fraction, int biased_exponent, int precision, int bias) -> boundaries
+   {
+      uint64_t const hidden_bit = uint64_t{1} << (precision - 1);
+
+      // denormals have no hidden bit and the smallest exponent
+      diyfp const v = biased_exponent == 0 ? diyfp{fraction, 1 - bias} : diyfp{fraction + hidden_bit, biased_exponent - bias};
+
+      // the lower neighbor is closer when v is an exact power of two (other than the smallest normal)
+      bool const lower_is_closer = fraction == 0 && biased_exponent > 1;
+
+      diyfp const plus = normalize({2 * v.f + 1, v.e - 1});
+      diyfp const minus = lower_is_closer ? diyfp{4 * v.f - 1, v.e - 2} : diyfp{2 * v.f - 1, v.e - 1};
+
+      return {normalize_to(minus, plus.e), plus};
+   }
+
+   // a normalized power of ten: f * 2^e ~= 10^k
+   struct cached_power
+   {
+      uint64_t f;
+      int e;
+      int k;
+   };
+
+   // return a power of ten c such that the product of c with a value of binary exponent e has an exponent in [-60, -32]
+   static auto cached_power_for(int e) -> cached_power
+   {
+      // powers 10^-300, 10^-292, ..., 10^324
+      static cached_power const POWERS[] =
+      {
+         {0xAB70FE17C79AC6CA, -1060, -300},
+         {0xFF77B1FCBEBCDC4F, -1034, -292},
+         {0xBE5691EF416BD60C, -1007, -284},
+         {0x8DD01FAD907FFC3C,  -980, -276},
+         {0xD3515C2831559A83,  -954, -268},
+         {0x9D71AC8FADA6C9B5,  -927, -260},
+         {0xEA9C227723EE8BCB,  -901, -252},
+         {0xAECC49914078536D,  -874, -244},
+         {0x823C12795DB6CE57,  -847, -236},
+         {0xC21094364DFB5637,  -821, -228},
+         {0x9096EA6F3848984F,  -794, -220},
+         {0xD77485CB25823AC7,  -768, -212},
+         {0xA086CFCD97BF97F4,  -741, -204},
+         {0xEF340A98172AACE5,  -715, -196},
+         {0xB23867FB2A35B28E,  -688, -188},
+         {0x84C8D4DFD2C63F3B,  -661, -180},
+         {0xC5DD44271AD3CDBA,  -635, -172},
+         {0x936B9FCEBB25C996,  -608, -164},
+         {0xDBAC6C247D62A584,  -582, -156},
+         {0xA3AB66580D5FDAF6,  -555, -148},
+         {0xF3E2F893DEC3F126,  -529, -140},
+         {0xB5B5ADA8AAFF80B8,  -502, -132},
+         {0x87625F056C7C4A8B,  -475, -124},
+         {0xC9BCFF6034C13053,  -449, -116},
+         {0x964E858C91BA2655,  -422, -108},
+         {0xDFF9772470297EBD,  -396, -100},
+         {0xA6DFBD9FB8E5B88F,  -369,  -92},
+         {0xF8A95FCF88747D94,  -343,  -84},
+         {0xB94470938FA89BCF,  -316,  -76},
+         {0x8A08F0F8BF0F156B,  -289,  -68},
+         {0xCDB02555653131B6,  -263,  -60},
+         {0x993FE2C6D07B7FAC,  -236,  -52},
+         {0xE45C10C42A2B3B06,  -210,  -44},
+         {0xAA242499697392D3,  -183,  -36},
+         {0xFD87B5F28300CA0E,  -157,  -28},
+         {0xBCE5086492111AEB,  -130,  -20},
+         {0x8CBCCC096F5088CC,  -103,  -12},
+         {0xD1B71758E219652C,   -77,   -4},
+         {0x9C40000000000000,   -50,    4},
+         {0xE8D4A51000000000,   -24,   12},
+         {0xAD78EBC5AC620000,     3,   20},
+         {0x813F3978F8940984,    30,   28},
+         {0xC097CE7BC90715B3,    56,   36},
+         {0x8F7E32CE7BEA5C70,    83,   44},
+         {0xD5D238A4ABE98068,   109,   52},
+         {0x9F4F2726179A2245,   136,   60},
+         {0xED63A231D4C4FB27,   162,   68},
+         {0xB0DE65388CC8ADA8,   189,   76},
+         {0x83C7088E1AAB65DB,   216,   84},
+         {0xC45D1DF942711D9A,   242,   92},
+         {0x924D692CA61BE758,   269,  100},
+         {0xDA01EE641A708DEA,   295,  108},
+         {0xA26DA3999AEF774A,   322,  116},
+         {0xF209787BB47D6B85,   348,  124},
+         {0xB454E4A179DD1877,   375,  132},
+         {0x865B86925B9BC5C2,   402,  140},
+         {0xC83553C5C8965D3D,   428,  148},
+         {0x952AB45CFA97A0B3,   455,  156},
+         {0xDE469FBD99A05FE3,   481,  164},
+         {0xA59BC234DB398C25,   508,  172},
+         {0xF6C69A72A3989F5C,   534,  180},
+         {0xB7DCBF5354E9BECE,   561,  188},
+         {0x88FCF317F22241E2,   588,  196},
+         {0xCC20CE9BD35C78A5,   614,  204},
+         {0x98165AF37B2153DF,   641,  212},
+         {0xE2A0B5DC971F303A,   667,  220},
+         {0xA8D9D1535CE3B396,   694,  228},
+         {0xFB9B7CD9A4A7443C,   720,  236},
+         {0xBB764C4CA7A44410,   747,  244},
+         {0x8BAB8EEFB6409C1A,   774,  252},
+         {0xD01FEF10A657842C,   800,  260},
+         {0x9B10A4E5E9913129,   827,  268},
+         {0xE7109BFBA19C0C9D,   853,  276},
+         {0xAC2820D9623BF429,   880,  284},
+         {0x80444B5E7AA7CF85,   907,  292},
+         {0xBF21E44003ACDD2D,   933,  300},
+         {0x8E679C2F5E44FF8F,   960,  308},
+         {0xD433179D9C8CB841,   986,  316},
+         {0x9E19DB92B4E31BA9,  1013,  324},
+      };
+
+      // ceil((-61 - e) * log10(2)), computed with integers
+      int const f = -61 - e;
+      int const k = (f * 78913) / (1 << 18) + (f > 0);
+
+      return POWERS[(300 + k + 7) / 8];
+   }
+
+   // return the number of digits of n (which is positive) and set 'power' to 10^(digits - 1)
+   static auto largest_power_of_ten(uint32_t n, uint32_t &power) -> int
+   {
+      int digits = 10;
+      power = 1000000000;
+
+      while(power > n)
+      {
+         power /= 10;
+         --digits;
+      }
+
+      return digits;
+   }
+
+   // nudge the last digit towards w while the result stays within the interval
+   static void round_last_digit(char *digits, int length, uint64_t distance, uint64_t delta, uint64_t rest, uint64_t ten_k)
+   {
+      while(rest < distance && delta - rest >= ten_k && (rest + ten_k < distance || distance - rest > rest + ten_k - distance))
+      {
+         --digits[length - 1];
+         rest += ten_k;
+      }
+   }
+
+   // generate the shortest digits within (minus, plus) closest to w, and the decimal exponent which goes with them
+   static void generate_digits(char *digits, int &length, int &exponent, diyfp minus, diyfp w, diyfp plus)
+   {
+      uint64_t delta = subtract(plus, minus).f;
+      uint64_t distance = subtract(plus, w).f;
+
+      // split plus into an integral part (at most 32 bits) and a fractional part
+      diyfp const one{uint64_t{1} << -plus.e, plus.e};
+
+      auto integral = static_cast<uint32_t>(plus.f >> -one.e);
+      uint64_t fractional = plus.f & (one.f - 1);
+
+      uint32_t power;
+      int remaining = largest_power_of_ten(integral, power);
+
+      length = 0;
+
+      while(remaining > 0)
+      {
+         digits[length++] = static_cast<char>('0' + integral / power);
+         integral %= power;
+         --remaining;
+
+         uint64_t const rest = (uint64_t{integral} << -one.e) + fractional;
+
+         // stop as soon as the digits generated so far fall within the interval
+         if(rest <= delta)
+         {
+            exponent += remaining;
+            round_last_digit(digits, length, distance, delta, rest, uint64_t{power} << -one.e);
+            return;
+         }
+
+         power /= 10;
+      }
+
+      // the integral digits were not enough, so continue into the fractional part
+      int fractional_digits = 0;
+
+      while(true)
+      {
+         fractional *= 10;
+         digits[length++] = static_cast<char>('0' + (fractional >> -one.e));
+         fractional &= one.f - 1;
+         ++fractional_digits;
+
+         delta *= 10;
+         distance *= 10;
+
+         if(fractional <= delta)
+         {
+            break;
+         }
+      }
+
+      exponent -= fractional_digits;
+      round_last_digit(digits, length, distance, delta, fractional, one.f);
+   }
+
+   // write the shortest digits of a positive value to 'digits' (at most 17) and set the value's exponent: value = digits * 10^exponent
+   static void shortest_digits(char *digits, int &length, int &exponent, uint64_t fraction, int biased_exponent, int precision, int bias)
+   {
+      boundaries const b = compute_boundaries(fraction, biased_exponent, precision, bias);
+
+      cached_power const c = cached_power_for(b.plus.e);
+      diyfp const c_minus_k{c.f, c.e};
+
+      // the scaled value itself is the midpoint of the scaled interval; only its distance to the upper boundary matters
+      diyfp const v = normalize(biased_exponent == 0 ? diyfp{fraction, 1 - bias} : diyfp{fraction + (uint64_t{1} << (precision - 1)), biased_exponent - bias});
+      diyfp const w = multiply(normalize_to(v, b.plus.e), c_minus_k);
+      diyfp const minus = multiply(b.minus, c_minus_k);
+      diyfp const plus = multiply(b.plus, c_minus_k);
+
+      exponent = -c.k;
+
+      // shrink the interval by one unit on each side to absorb the error of the multiplications
+      generate_digits(digits, length, exponent, {minus.f + 1, minus.e}, w, {plus.f - 1, plus.e});
+   }
+
+   // a decomposed floating-point value
+   struct decimal
+   {
+      // set for negative values (including negative zero)
+      bool negative;
+
+      // set for infinities and NaNs, which are written by name
+      char const *special;
+
+      // significant digits; value = 0.digits * 10^point
+      char digits[20];
+      int length;
+      int point;
+   };
+
+   // decompose 'value' into sign and shortest digits
+   static auto decompose(uint64_t bits, int fraction_bits, int exponent_bits, int bias) -> decimal
+   {
+      decimal d;
+
+      d.negative = (bits >> (fraction_bits + exponent_bits)) & 1;
+      d.special = nullptr;
+
+      uint64_t const fraction = bits & ((uint64_t{1} << fraction_bits) - 1);
+      auto const biased_exponent = static_cast<int>((bits >> fraction_bits) & ((uint64_t{1} << exponent_bits) - 1));
+
+      if(biased_exponent == (1 << exponent_bits) - 1)
+      {
+         d.special = fraction ? "nan" : "inf";
+
+         // the sign of a NaN carries no meaning
+         if(fraction) d.negative = false;
+      }
+      else if(biased_exponent == 0 && fraction == 0)
+      {
+         d.digits[0] = '0';
+         d.length = 1;
+         d.point = 1;
+      }
+      else
+      {
+         int exponent;
+
+         shortest_digits(d.digits, d.length, exponent, fraction, biased_exponent, fraction_bits + 1, bias + fraction_bits);
+
+         d.point = d.length + exponent;
+      }
+
+      return d;
+   }
+
+   // decompose a double
+   static auto decompose(double value) -> decimal
+   {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+
+      return decompose(bits, 52, 11, 1023);
+   }
+
+   // decompose a float
+   static auto decompose(float value) -> decimal
+   {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+
+      return decompose(bits, 23, 8, 127);
+   }
+
+   // write 'count' copies of 'c'
+   static auto fill(char *out, char c, int count) -> char *
+   {
+      if(count <= 0) return out;
+
+      std::memset(out, c, static_cast<std::size_t>(count));
+      return out + count;
+   }
+
+   // write 'count' digits
+   static auto copy(char *out, char const *digits, int count) -> char *
+   {
+      if(count <= 0) return out;
+
+      std::memcpy(out, digits, static_cast<std::size_t>(count));
+      return out + count;
+   }
+
+   // write the decomposed value in the notation JavaScript uses for numbers: plain for exponents up to 21, scientific otherwise
+   static auto format_shortest(char *out, decimal const &d) -> char *
+   {
+      if(d.negative) *out++ = '-';
+
+      if(d.special)
+      {
+         return copy(out, d.special, 3);
+      }
+
+      if(d.length <= d.point && d.point <= 21)
+      {
+         // integer: the digits followed by zeros
+         out = copy(out, d.digits, d.length);
+         return fill(out, '0', d.point - d.length);
+      }
+
+      if(0 < d.point && d.point <= 21)
+      {
+         // the point falls within the digits
+         out = copy(out, d.digits, d.point);
+         *out++ = '.';
+         return copy(out, d.digits + d.point, d.length - d.point);
+      }
+
+      if(-6 < d.point && d.point <= 0)
+      {
+         // small fraction: zeros between the point and the digits
+         *out++ = '0';
+         *out++ = '.';
+         out = fill(out, '0', -d.point);
+         return copy(out, d.digits, d.length);
+      }
+
+      // scientific: one digit before the point
+      *out++ = d.digits[0];
+
+      if(d.length > 1)
+      {
+         *out++ = '.';
+         out = copy(out, d.digits + 1, d.length - 1);
+      }
+
+      *out++ = 'e';
+      *out++ = d.point > 0 ? '+' : '-';
+
+      return format_decimal(out, static_cast<unsigned long long>(d.point > 0 ? d.point - 1 : 1 - d.point));
+   }
+
+   auto format_shortest(char *out, double value) -> char *
+   {
+      return format_shortest(out, decompose(value));
+   }
+
+   auto format_shortest(char *out, float value) -> char *
+   {
+      return format_shortest(out, decompose(value));
+   }
+
+   // decompose 'value' and round its digits so that none remain past 'precision' digits after the point
+   static auto round_fixed(double value, unsigned precision) -> decimal
+   {
+      decimal d = decompose(value);
+
+      if(d.special)
+      {
+         return d;
+      }
+
+      // number of digits which remain in front of the rounding position
+      long const keep = static_cast<long>(d.point) + static_cast<long>(precision);
+
+      if(keep >= d.length)
+      {
+         return d;
+      }
+
+      bool const round_up = keep >= 0 && d.digits[keep] >= '5';
+
+      d.length = keep > 0 ? static_cast<int>(keep) : 0;
+
+      if(round_up)
+      {
+         // propagate the carry through trailing nines
+         int i = d.length - 1;
+
+         while(i >= 0 && d.digits[i] == '9')
+         {
+            --i;
+         }
+
+         if(i >= 0)
+         {
+            ++d.digits[i];
+            d.length = i + 1;
+         }
+         else
+         {
+            // every kept digit was a nine (or none were kept): the result is a single one, one position further left
+            d.digits[0] = '1';
+            d.length = 1;
+            ++d.point;
+         }
+      }
+
+      if(d.length == 0)
+      {
+         // everything was rounded away
+         d.digits[0] = '0';
+         d.length = 1;
+         d.point = 1;
+      }
+
+      return d;
+   }
+
+   auto fixed_size(double value, unsigned precision) -> std::size_t
+   {
+      decimal const d = round_fixed(value, precision);
+
+      std::size_t const sign = d.negative ? 1 : 0;
+
+      if(d.special)
+      {
+         return sign + 3;
+      }
+
+      std::size_t const integral = d.point > 0 ? static_cast<std::size_t>(d.point) : 1;
+
+      return sign + integral + (precision ? precision + 1 : 0);
+   }
+
+   auto format_fixed(char *out, double value, unsigned precision) -> char *
+   {
+      decimal const d = round_fixed(value, precision);
+
+      if(d.negative) *out++ = '-';
+
+      if(d.special)
+      {
+         return copy(out, d.special, 3);
+      }
+
+      // integral part: leading digits, then zeros up to the point
+      if(d.point > 0)
+      {
+         int const digits = d.point < d.length ? d.point : d.length;
+
+         out = copy(out, d.digits, digits);
+         out = fill(out, '0', d.point - digits);
+      }
+      else
+      {
+         *out++ = '0';
+      }
+
+      if(!precision)
+      {
+         return out;
+      }
+
+      *out++ = '.';
+
+      // fractional part: zeros up to the first digit, the digits after the point, then zeros up to the precision
+      for(long position = d.point; position < static_cast<long>(d.point) + static_cast<long>(precision); ++position)
+      {
+         *out++ = (position >= 0 && position < d.length) ? d.digits[position] : '0';
+      }
+
+      return out;
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                    Self-Tests                                                                 ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef MDT_SELF_TEST
+
+// std::numeric_limits
+#include <limits>
+
+// std::mt19937_64
+#include <random>
+
+// std::strtod(), std::strtof()
+#include <cstdlib>
+
+// std::string
+#include <string>
+
+namespace mdt { namespace test { namespace number_format
+{
+   // format with one of the buffer-based functions and return the result as a string
+   template<typename T>
+   static auto shortest(T value) -> std::string
+   {
+      char buffer[max_shortest_chars];
+      return std::string(buffer, format_shortest(buffer, value));
+   }
+
+   static auto fixed(double value, unsigned precision) -> std::string
+   {
+      std::string s(fixed_size(value, precision), '\0');
+      format_fixed(&s[0], value, precision);
+      return s;
+   }
+
+   auto all() -> result
+   {
+      test::result result{"number formatting tests"};
+
+      /**
+       * (1) Ensure that integers are written exactly, including the extremes.
+       */
+      {
+         char buffer[max_integer_chars];
+
+         bool correct = true;
+
+         for(long long value : {0LL, 7LL, -7LL, 10LL, 99LL, 100LL, 12345LL, -1000000LL, std::numeric_limits<long long>::max(),
+                                std::numeric_limits<long long>::min()})
+         {
+            correct = correct && std::string(buffer, format_decimal(buffer, value)) == std::to_string(value);
+         }
+
+         correct = correct && std::string(buffer, format_decimal(buffer, std::numeric_limits<unsigned long long>::max())) == "18446744073709551615";
+
+         result << test::result{"decimal integers", correct};
+
+         result << test::result
+         {
+            "hexadecimal integers",
+            std::string(buffer, format_hex(buffer, 0)) == "0" && std::string(buffer, format_hex(buffer, 0xbeef, 8)) == "0000beef" &&
+            std::string(buffer, format_hex(buffer, std::numeric_limits<unsigned long long>::max())) == "ffffffffffffffff"
+         };
+      }
+
+      /**
+       * (2) Ensure that floating-point values are written in their shortest form.
+       */
+      {
+         result << test::result
+         {
+            "shortest doubles",
+            shortest(0.0) == "0" && shortest(-0.0) == "-0" && shortest(1.5) == "1.5" && shortest(0.1) == "0.1" && shortest(100.0) == "100" &&
+            shortest(1e21) == "1e+21" && shortest(1e-7) == "1e-7" && shortest(0.000001) == "0.000001" && shortest(-2.5e-300) == "-2.5e-300" &&
+            shortest(5e-324) == "5e-324" && shortest(1.7976931348623157e308) == "1.7976931348623157e+308" && shortest(1.0 / 3) == "0.3333333333333333"
+         };
+
+         result << test::result{"shortest floats", shortest(0.1f) == "0.1" && shortest(16777216.0f) == "16777216" && shortest(3.4028235e38f) == "3.4028235e+38"};
+
+         result << test::result
+         {
+            "special values",
+            shortest(std::numeric_limits<double>::infinity()) == "inf" && shortest(-std::numeric_limits<double>::infinity()) == "-inf" &&
+            shortest(std::numeric_limits<double>::quiet_NaN()) == "nan"
+         };
+      }
+
+      /**
+       * (3) Ensure that random doubles and floats read back exactly.
+       */
+      {
+         std::mt19937_64 random{12345};
+
+         bool exact = true;
+
+         for(int i = 0; exact && i < 100000; ++i)
+         {
+            uint64_t bits = random();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            if(value != value || value - value != 0) continue;
+
+            exact = std::strtod(shortest(value).c_str(), nullptr) == value;
+         }
+
+         result << test::result{"random doubles round-trip", exact};
+
+         for(int i = 0; exact && i < 100000; ++i)
+         {
+            auto bits = static_cast<uint32_t>(random());
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            if(value != value || value - value != 0) continue;
+
+            exact = std::strtof(shortest(value).c_str(), nullptr) == value;
+         }
+
+         result << test::result{"random floats round-trip", exact};
+      }
+
+      /**
+       * (4) Ensure that fixed-point values are rounded to the requested precision.
+       */
+      {
+         result << test::result
+         {
+            "fixed precision",
+            fixed(1.5, 0) == "2" && fixed(3.14159, 2) == "3.14" && fixed(-0.125, 2) == "-0.13" && fixed(9.999, 2) == "10.00" &&
+            fixed(0.0004, 3) == "0.000" && fixed(0.0005, 3) == "0.001" && fixed(1e20, 1) == "100000000000000000000.0" && fixed(42, 3) == "42.000"
+         };
+      }
+
+      return result;
+   }
+}}}
+
+#endif
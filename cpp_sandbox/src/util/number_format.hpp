@@ -0,0 +1,48 @@
+#ifndef NUMBER_FORMAT_HPP_
+#define NUMBER_FORMAT_HPP_
+
+// std::size_t
+#include <cstddef>
+
+namespace mdt
+{
+   // enough room for any integer written by format_decimal() or format_hex() (sign, 20 digits or 16 hex digits)
+   constexpr std::size_t max_integer_chars = 24;
+
+   // enough room for any value written by format_shortest() (sign, 17 digits, point, exponent)
+   constexpr std::size_t max_shortest_chars = 32;
+
+   // write the decimal digits of 'value' to 'out' and return the position just past them
+   auto format_decimal(char *out, unsigned long long value) -> char *;
+
+   // write the decimal digits of 'value' (preceded by '-' if it is negative) to 'out' and return the position just past them
+   auto format_decimal(char *out, long long value) -> char *;
+
+   // write the lower-case hexadecimal digits of 'value', zero-padded to at least 'width' digits, and return the position just past them
+   auto format_hex(char *out, unsigned long long value, unsigned width = 0) -> char *;
+
+   // write the shortest decimal representation which reads back as exactly 'value' and return the position just past it
+   auto format_shortest(char *out, double value) -> char *;
+
+   // same as above, but shortest among the representations which read back as exactly the single-precision 'value'
+   auto format_shortest(char *out, float value) -> char *;
+
+   // return the number of characters format_fixed() will write for 'value' with 'precision' digits after the point
+   auto fixed_size(double value, unsigned precision) -> std::size_t;
+
+   // write 'value' with exactly 'precision' digits after the point (rounded half-up from its shortest representation); 'out' must have room
+   // for fixed_size() characters
+   auto format_fixed(char *out, double value, unsigned precision) -> char *;
+}
+
+#ifdef MDT_SELF_TEST
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace number_format
+{
+   // run all number formatting tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* NUMBER_FORMAT_HPP_ */
@@ -15,6 +15,9 @@
 // std::list
 #include <list>
 
+// std::unique_ptr
+#include <memory>
+
 // std::string
 #include <string>
 
@@ -274,6 +277,116 @@ namespace mdt { namespace test { namespace pending_queue { namespace ints
    }
 }}}}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// in-place tests ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// tests for element types which cannot be default-constructed or copied, and for elements processed in their queue slots
+namespace mdt { namespace test { namespace pending_queue { namespace in_place
+{
+   // move-only element without a default constructor
+   struct ticket
+   {
+      explicit ticket(int number) : number{new int{number}} {}
+
+      std::unique_ptr<int> number;
+   };
+
+   // large element which counts how often it is copied or moved
+   struct page
+   {
+      explicit page(int &transfers) : transfers(&transfers), bytes{} {}
+      page(page const &other) : transfers(other.transfers), bytes{} { ++*transfers; }
+      page(page &&other) : transfers(other.transfers), bytes{} { ++*transfers; }
+
+      int *transfers;
+      char bytes[4096];
+   };
+
+   static auto all() -> test::result
+   {
+      test::result result("in-place tests");
+
+      /**
+       ** (1) Ensure that a move-only element type without a default constructor can be queued, whether the call-back takes elements by value or
+       **     works on them in place.
+       **/
+      {
+         std::vector<int> by_value;
+         std::vector<int> in_place;
+
+         mdt::pending_queue<ticket> v([&by_value](ticket t){ by_value.push_back(*t.number); });
+         mdt::pending_queue<ticket> p(mdt::in_place, [&in_place](ticket &t){ in_place.push_back(*t.number); });
+
+         {
+            // start both queue threads
+            local(v.go());
+            local(p.go());
+
+            for(int i = 0; i < 5; ++i)
+            {
+               v.add(ticket{i});
+               p.emplace(i);
+            }
+
+            // end both queue threads
+         }
+
+         result << test::result{"move-only elements -> by-value call-back", equal_containers(by_value, std::vector<int>{0, 1, 2, 3, 4})};
+         result << test::result{"move-only elements -> in-place call-back", equal_containers(in_place, std::vector<int>{0, 1, 2, 3, 4})};
+      }
+
+      /**
+       ** (2) Ensure that an element emplaced into an in-place queue reaches the call-back where it was constructed, without being copied or moved.
+       **/
+      {
+         int transfers = 0;
+         int processed = 0;
+
+         mdt::pending_queue<page> q(mdt::in_place, [&processed](page &p){ processed += p.bytes[0] == 0; });
+
+         {
+            // start and end the queue thread
+            local(q.go());
+
+            for(int i = 0; i < 100; ++i)
+            {
+               q.emplace(transfers);
+            }
+         }
+
+         result << test::result{"emplace -> in-place call-back = no copies or moves", processed == 100 && transfers == 0};
+      }
+
+      /**
+       ** (3) Ensure that stopped queues throw back an emplaced element.
+       **/
+      try
+      {
+         mdt::pending_queue<ticket> q(mdt::in_place, [](ticket &){});
+
+         {
+            // start and end the queue thread
+            local(q.go());
+         }
+
+         q.emplace(42);
+
+         result << test::result{"emplacing into a stopped queue should have thrown an exception", false};
+      }
+      catch(ticket const &t)
+      {
+         result << test::result{"emplacing into a stopped queue should throw the element", *t.number == 42};
+      }
+      catch(...)
+      {
+         result << test::result{"caught wrong exception type (should be 'ticket')", false};
+      }
+
+      return result;
+   }
+}}}}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// test interface ///
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -283,8 +396,78 @@ namespace mdt { namespace test { namespace pending_queue
    // run all pending queue tests
    auto all() -> result
    {
-      // create the base result then append the string and integer tests as children
-      return result{"pending_queue tests"} << strings::all() << ints::all();
+      // create the base result then append the string, integer and in-place tests as children
+      return result{"pending_queue tests"} << strings::all() << ints::all() << in_place::all();
+   }
+}}}
+
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Benchmarks                                                                   ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+
+// std::size_t
+#include <cstddef>
+
+// mdt::pending_queue
+#include "pending_queue.hpp"
+
+namespace mdt { namespace bench { namespace pending_queue
+{
+   void add_cases(suite &cases)
+   {
+      /**
+       * (1) Throughput: elements added from one thread and processed by the queue's thread, including starting and ending the queue once.
+       */
+      cases.add("pending_queue add() throughput", [](std::size_t iterations)
+      {
+         std::size_t sum = 0;
+         mdt::pending_queue<std::size_t> q([&sum](std::size_t i){ sum += i; });
+
+         {
+            // start the queue thread
+            local(q.go());
+
+            for(std::size_t i = 0; i < iterations; ++i)
+            {
+               q.add(i);
+            }
+
+            // end the queue thread after processing every element
+         }
+
+         keep(sum);
+      });
+
+      /**
+       * (2) Latency: each element is added and then waited for with sync(), so every iteration is a round trip between the two threads.
+       */
+      cases.add("pending_queue add() + sync() round trip", [](std::size_t iterations)
+      {
+         std::size_t sum = 0;
+         mdt::pending_queue<std::size_t> q([&sum](std::size_t i){ sum += i; });
+
+         {
+            // start the queue thread
+            local(q.go());
+
+            for(std::size_t i = 0; i < iterations; ++i)
+            {
+               q.add(i);
+               q.sync();
+            }
+
+            // end the queue thread
+         }
+
+         keep(sum);
+      });
    }
 }}}
 
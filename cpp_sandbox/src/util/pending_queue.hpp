@@ -16,18 +16,24 @@
 // std::mutex(), std::unique_lock(), std::lock_guard()
 #include <mutex>
 
-// std::queue()
-#include <queue>
-
 // std::thread()
 #include <thread>
 
-// std::move()
+// std::forward(), std::move()
 #include <utility>
 
 // mdt::wrap()
 #include "defer.hpp"
 
+// mdt::recycle_pool()
+#include "recycle_pool.hpp"
+
+// mdt::slot_queue()
+#include "slot_queue.hpp"
+
+// mdt::trace::record()
+#include "trace.hpp"
+
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///                                                                                                                                               ///
@@ -50,6 +56,12 @@
 
 namespace mdt
 {
+   // tag selecting the pending_queue constructor whose call-back works on each element in its queue slot
+   struct in_place_t {};
+
+   // instance of the in_place_t tag
+   constexpr in_place_t in_place{};
+
    /**
     * Thread-safe queue into which elements can be enqueued from any thread, but are processed sequentially by the queue's internal thread.
     */
@@ -76,7 +88,26 @@ namespace mdt
          :
          callback{callback},
          ending{false},
-         paused{false}
+         paused{false},
+         enqueued{0},
+         dequeued{0}
+      {}
+
+      // construct a pending queue whose call-back borrows each element; once the call-back returns, the element is handed back to 'pool'
+      public: pending_queue(std::function<void(element_type &)> callback, recycle_pool<element_type> &pool)
+         :
+         pending_queue{in_place, [callback, &pool](element_type &element){ callback(element); pool.release(std::move(element)); }}
+      {}
+
+      // construct a pending queue whose call-back works on each element where it is stored in the queue; the element is destroyed once the
+      // call-back returns, so it is never moved after being added (and element_type needs neither a default constructor nor a copy constructor)
+      public: pending_queue(in_place_t, std::function<void(element_type &)> callback)
+         :
+         borrow_callback{callback},
+         ending{false},
+         paused{false},
+         enqueued{0},
+         dequeued{0}
       {}
 
       // disallow copying via copy constructor
@@ -90,11 +121,14 @@ namespace mdt
          :
          // copy the trivial types
          ending{other.ending},
-         paused{other.paused}
+         paused{other.paused},
+         enqueued{other.enqueued},
+         dequeued{other.dequeued}
       {
          // swap the complex types
          queue.swap(other.queue);
          callback.swap(other.callback);
+         borrow_callback.swap(other.borrow_callback);
          thread.swap(other.thread);
       }
 
@@ -171,11 +205,19 @@ namespace mdt
                // ...notify the process() thread that it is no longer paused
                event.notify_one();
             }
+
+            trace::record(pause ? trace::event::pause : trace::event::resume, this);
          }
       }
 
       // move a new element onto the queue (unless end() has been called, in which case the element will be thrown back to the caller)
       public: void add(element_type element)
+      {
+         emplace(std::move(element));
+      }
+
+      // construct a new element in place on the queue (unless end() has been called, in which case the element will be thrown to the caller)
+      public: template<typename... Args> void emplace(Args &&... args)
       {
          // make this function thread-safe
          std::lock_guard<std::mutex> lock(queue_lock);
@@ -184,11 +226,12 @@ namespace mdt
          if(ending)
          {
             // ...so throw the element back to the caller
-            throw std::move(element);
+            throw element_type(std::forward<Args>(args)...);
          }
 
-         // otherwise, move the element onto the queue...
-         queue.push(std::move(element));
+         // otherwise, construct the element in its queue slot...
+         queue.emplace(std::forward<Args>(args)...);
+         trace::record(trace::event::enqueue, this, enqueued++);
 
          // ...and notify the process() thread that an event has occurred
          event.notify_one();
@@ -199,8 +242,12 @@ namespace mdt
       {
          while(true)
          {
-            // create a temporary element for storing the popped-off element
-            element_type element;
+            // the element being processed; it stays in its queue slot (which does not move while more elements are added) until the call-back
+            // returns, and since only this thread pops, it can be used without holding the lock
+            element_type *element;
+
+            // sequence number of the element, matching the one recorded when it was added
+            uint64_t id;
 
             {
                // ensure that no new elements are added to the queue while we're interacting with it
@@ -220,21 +267,36 @@ namespace mdt
                   event.wait(lock);
                }
 
-               // since an element exists in the queue, move it to the temporary element...
-               element = std::move(queue.front());
+               // since an element exists in the queue, take the oldest one
+               element = &queue.front();
 
-               // ...pop it off the queue...
-               queue.pop();
+               id = dequeued++;
+               trace::record(trace::event::dequeue, this, id);
             }
 
-            // ...and move it to the call-back
-            callback(std::move(element));
+            trace::record(trace::event::callback_begin, this, id);
+
+            // either lend the element to the call-back...
+            if(borrow_callback)
+            {
+               borrow_callback(*element);
+            }
+            // ...or move it to the call-back
+            else
+            {
+               callback(std::move(*element));
+            }
+
+            trace::record(trace::event::callback_end, this, id);
 
             {
                // ensure that no new elements are added to the queue while we're interacting with it
                std::unique_lock<std::mutex> lock{queue_lock};
 
-               // if the queue is now empty...
+               // free the element's slot...
+               queue.pop();
+
+               // ...and if the queue is now empty...
                if(queue.empty())
                {
                   // notify the sync() function *after* the callback is called
@@ -249,12 +311,17 @@ namespace mdt
       ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Variables ///
       ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-      // queue of the pending elements which have yet to be handled by the process() function
-      private: std::queue<element_type> queue;
+      // queue of the pending elements which have yet to be handled by the process() function; its blocks are recycled, so adding and
+      // processing elements does not allocate once the queue has reached its working depth
+      private: slot_queue<element_type> queue;
 
       // supplied by the pending_queue creator, this is called for each element processed by the process() function
       private: std::function<void(element_type)> callback;
 
+      // used instead of 'callback' when the call-back works on elements in place (including when it recycles them into a pool afterwards); the
+      // element is only borrowed for the duration of the call
+      private: std::function<void(element_type &)> borrow_callback;
+
       // runs the process() function
       private: std::thread thread;
 
@@ -264,6 +331,10 @@ namespace mdt
       // true if the queue is paused (i.e., accepting new input but not processing it)
       private: bool paused;
 
+      // sequence numbers given to the elements as they are added and taken off the queue, so that traced events can be paired up
+      private: uint64_t enqueued;
+      private: uint64_t dequeued;
+
       // makes 'queue' and 'ending' thread-safe
       private: std::mutex queue_lock;
 
@@ -292,4 +363,15 @@ namespace mdt { namespace test { namespace pending_queue
 }}}
 #endif
 
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+// mdt::bench::suite
+#include "../test/bench.hpp"
+
+namespace mdt { namespace bench { namespace pending_queue
+{
+   // add the pending_queue benchmark cases
+   void add_cases(suite &cases);
+}}}
+#endif
+
 #endif /* PENDING_QUEUE_HPP_ */
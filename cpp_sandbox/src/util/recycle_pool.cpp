@@ -0,0 +1,163 @@
+#ifdef MDT_SELF_TEST
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// std::atomic()
+#include <atomic>
+
+// std::string
+#include <string>
+
+// std::thread()
+#include <thread>
+
+// std::vector
+#include <vector>
+
+// mdt::pending_queue
+#include "pending_queue.hpp"
+
+// mdt::recycle_pool
+#include "recycle_pool.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////// recycle_pool<std::string> tests ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt { namespace test { namespace recycle_pool { namespace strings
+{
+   static auto all() -> test::result
+   {
+      test::result result("std::string tests");
+
+      /**
+       ** (1) Ensure that an empty pool hands out fresh elements and that a released element's buffer is handed out again, cleared.
+       **/
+      {
+         mdt::recycle_pool<std::string> pool(4);
+
+         std::string s = pool.acquire();
+
+         result << test::result{"empty pool -> acquire = empty element", s.empty() && s.capacity() <= std::string().capacity()};
+
+         // grow the buffer well past any small-string optimization and remember where it lives
+         s.assign(1000, 'x');
+         auto const buffer = s.data();
+         auto const capacity = s.capacity();
+
+         pool.release(std::move(s));
+
+         std::string recycled = pool.acquire();
+
+         result << test::result{"release -> acquire = same buffer", recycled.data() == buffer && recycled.capacity() == capacity};
+         result << test::result{"release -> acquire = cleared element", recycled.empty()};
+      }
+
+      /**
+       ** (2) Ensure that releasing into a full pool drops the extra elements instead of blocking or overwriting.
+       **/
+      {
+         mdt::recycle_pool<std::string> pool(2);
+
+         for(int i = 0; i < 3; ++i)
+         {
+            pool.release(std::string(100, 'x'));
+         }
+
+         bool recycled_first = pool.acquire().capacity() >= 100;
+         bool recycled_second = pool.acquire().capacity() >= 100;
+         bool fresh_third = pool.acquire().capacity() < 100;
+
+         result << test::result{"release into full pool drops the element", recycled_first && recycled_second && fresh_third};
+      }
+
+      /**
+       ** (3) Ensure that concurrent acquire/release never hands the same buffer to two threads at once.
+       **/
+      {
+         mdt::recycle_pool<std::string> pool(16);
+         std::atomic<bool> intact{true};
+         std::vector<std::thread> threads;
+
+         for(char id = 'a'; id < 'e'; ++id)
+         {
+            threads.emplace_back([&pool, &intact, id]
+            {
+               for(int i = 0; i < 10000; ++i)
+               {
+                  std::string s = pool.acquire();
+
+                  s.assign(64, id);
+
+                  // another thread writing into the same buffer would show up as a foreign character
+                  if(s.find_first_not_of(id) != std::string::npos) intact = false;
+
+                  pool.release(std::move(s));
+               }
+            });
+         }
+
+         for(auto &thread : threads) thread.join();
+
+         result << test::result{"concurrent acquire/release keeps buffers exclusive", intact};
+      }
+
+      /**
+       ** (4) Ensure that a recycling pending_queue lends each element to the call-back and returns its buffer to the pool afterwards.
+       **/
+      {
+         mdt::recycle_pool<std::string> pool;
+         std::vector<std::string> output;
+
+         mdt::pending_queue<std::string> q([&](std::string &s){output.push_back(s);}, pool);
+
+         {
+            // start the queue thread
+            local(q.go());
+
+            for(int i = 0; i < 8; ++i)
+            {
+               std::string s = pool.acquire();
+               s.assign(100, static_cast<char>('a' + i));
+               q.add(std::move(s));
+            }
+
+            q.sync();
+
+            // end the queue thread
+         }
+
+         bool in_order = output.size() == 8;
+
+         for(std::size_t i = 0; in_order && i < output.size(); ++i)
+         {
+            in_order = output[i] == std::string(100, static_cast<char>('a' + i));
+         }
+
+         result << test::result{"recycling queue -> add -> sync = flushed output", in_order};
+         result << test::result{"recycling queue -> acquire = recycled buffer", pool.acquire().capacity() >= 100};
+      }
+
+      return result;
+   }
+}}}}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// test interface ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt { namespace test { namespace recycle_pool
+{
+   // run all recycle pool tests
+   auto all() -> result
+   {
+      return result{"recycle_pool tests"} << strings::all();
+   }
+}}}
+
+#endif
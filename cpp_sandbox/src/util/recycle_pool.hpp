@@ -0,0 +1,262 @@
+#ifndef RECYCLE_POOL_HPP_
+#define RECYCLE_POOL_HPP_
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// std::atomic()
+#include <atomic>
+
+// std::size_t, std::ptrdiff_t
+#include <cstddef>
+
+// std::unique_ptr()
+#include <memory>
+
+// std::move()
+#include <utility>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                            recycle_pool Definition                                                            ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   /**
+    * Lock-free, bounded pool of spare elements (typically buffers such as std::string) which lets any thread hand a processed element back so that
+    * another thread can re-use its storage instead of going through the global allocator. If the element type provides clear(), it is called
+    * before an element is stored so that only its capacity is recycled.
+    */
+   template<class T>
+   class recycle_pool
+   {
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Type Definitions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // stored element type, provided for cases in which the type is difficult to deduce
+      public: typedef T element_type;
+
+      // the type of this templated class, provided for cases in which the type is difficult to deduce
+      public: typedef recycle_pool<element_type> class_type;
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Functions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // construct a pool which holds at most 'capacity' spare elements (rounded up to the next power of two)
+      public: explicit recycle_pool(std::size_t capacity = 1024)
+         :
+         mask{round_up(capacity) - 1},
+         cells{new cell[mask + 1]},
+         push_position{0},
+         pop_position{0}
+      {
+         // each cell starts out free for the push at its own position
+         for(std::size_t i = 0; i <= mask; ++i)
+         {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+         }
+      }
+
+      // disallow copying via copy constructor
+      public: recycle_pool(class_type const &) = delete;
+
+      // disallow copying via assignment operator
+      public: class_type & operator=(class_type const &) = delete;
+
+      // disallow move via move constructor (producers and consumers hold references to the pool)
+      public: recycle_pool(class_type &&) = delete;
+
+      // disallow move via assignment operator
+      public: class_type & operator=(class_type &&) = delete;
+
+      // empty destructor
+      public: ~recycle_pool() {}
+
+      // take a spare element out of the pool, or a newly-constructed element if the pool is empty
+      public: auto acquire() -> element_type
+      {
+         element_type element;
+
+         // if nothing was recycled, the freshly-constructed element is returned instead
+         pop(element);
+
+         return element;
+      }
+
+      // clear the element and store it for re-use; if the pool is already full, the element is simply destroyed
+      public: void release(element_type element)
+      {
+         reset(element, 0);
+
+         push(element);
+      }
+
+      // return the maximum number of spare elements held by the pool
+      public: auto capacity() const -> std::size_t
+      {
+         return mask + 1;
+      }
+
+      // round the requested capacity up to a power of two so that positions can be mapped to cells with a mask
+      private: static auto round_up(std::size_t capacity) -> std::size_t
+      {
+         std::size_t result = 2;
+
+         while(result < capacity)
+         {
+            result <<= 1;
+         }
+
+         return result;
+      }
+
+      // empty an element which provides clear()
+      private: template<class U> static auto reset(U &element, int) -> decltype(element.clear(), void())
+      {
+         element.clear();
+      }
+
+      // elements without clear() are stored as they are
+      private: template<class U> static void reset(U &, long) {}
+
+      // move the element into the next free cell; returns false if the pool is full
+      private: auto push(element_type &element) -> bool
+      {
+         std::size_t position = push_position.load(std::memory_order_relaxed);
+         cell *target;
+
+         while(true)
+         {
+            target = &cells[position & mask];
+
+            // the cell is free for this position when its sequence equals the position
+            auto const difference = static_cast<std::ptrdiff_t>(target->sequence.load(std::memory_order_acquire) - position);
+
+            if(difference == 0)
+            {
+               // claim the position; on failure 'position' is reloaded with the current value
+               if(push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+               {
+                  break;
+               }
+            }
+            else if(difference < 0)
+            {
+               // the cell still holds an element from the previous lap, so the pool is full
+               return false;
+            }
+            else
+            {
+               // another producer claimed this position first
+               position = push_position.load(std::memory_order_relaxed);
+            }
+         }
+
+         target->element = std::move(element);
+
+         // publish the element to consumers
+         target->sequence.store(position + 1, std::memory_order_release);
+
+         return true;
+      }
+
+      // move the oldest stored element out of the pool; returns false if the pool is empty
+      private: auto pop(element_type &element) -> bool
+      {
+         std::size_t position = pop_position.load(std::memory_order_relaxed);
+         cell *target;
+
+         while(true)
+         {
+            target = &cells[position & mask];
+
+            // the cell holds an element for this position when its sequence is one ahead of the position
+            auto const difference = static_cast<std::ptrdiff_t>(target->sequence.load(std::memory_order_acquire) - (position + 1));
+
+            if(difference == 0)
+            {
+               // claim the position; on failure 'position' is reloaded with the current value
+               if(pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+               {
+                  break;
+               }
+            }
+            else if(difference < 0)
+            {
+               // nothing has been published at this position yet, so the pool is empty
+               return false;
+            }
+            else
+            {
+               // another consumer claimed this position first
+               position = pop_position.load(std::memory_order_relaxed);
+            }
+         }
+
+         element = std::move(target->element);
+
+         // free the cell for the producer one lap ahead
+         target->sequence.store(position + mask + 1, std::memory_order_release);
+
+         return true;
+      }
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Variables ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // a single pool entry; 'sequence' tells producers and consumers whose turn it is to touch 'element'
+      private: struct cell
+      {
+         std::atomic<std::size_t> sequence;
+         element_type element;
+      };
+
+      // number of cells minus one
+      private: std::size_t const mask;
+
+      // ring of cells holding the spare elements
+      private: std::unique_ptr<cell[]> cells;
+
+      // padding which keeps the producer and consumer positions on separate cache lines
+      private: char padding_a[64];
+
+      // next position to be written by release()
+      private: std::atomic<std::size_t> push_position;
+
+      // padding which keeps the producer and consumer positions on separate cache lines
+      private: char padding_b[64];
+
+      // next position to be read by acquire()
+      private: std::atomic<std::size_t> pop_position;
+   };
+}
+
+#ifdef MDT_SELF_TEST
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                    Self-Tests                                                                 ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// mdt::test::result
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace recycle_pool
+{
+   // run all recycle_pool self-tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* RECYCLE_POOL_HPP_ */
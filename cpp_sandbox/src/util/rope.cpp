@@ -0,0 +1,352 @@
+// std::min()
+#include <algorithm>
+
+// errno, EINTR
+#include <cerrno>
+
+// IOV_MAX
+#include <climits>
+
+// std::memcpy(), std::memmove()
+#include <cstring>
+
+// std::system_error, std::system_category()
+#include <system_error>
+
+// writev(), struct iovec
+#include <sys/uio.h>
+
+// mdt::rope
+#include "rope.hpp"
+
+namespace mdt
+{
+   rope::rope(std::size_t chunk_size)
+      :
+      chunk_size{chunk_size},
+      current{0},
+      used{0}
+   {}
+
+   rope::rope(rope &&other)
+      :
+      chunk_size{other.chunk_size},
+      chunks{std::move(other.chunks)},
+      current{other.current},
+      used{other.used},
+      scratch{std::move(other.scratch)}
+   {
+      other.chunks.clear();
+      other.current = 0;
+      other.used = 0;
+   }
+
+   auto rope::operator=(rope &&other) -> rope &
+   {
+      if(this != &other)
+      {
+         chunk_size = other.chunk_size;
+         chunks = std::move(other.chunks);
+         current = other.current;
+         used = other.used;
+         scratch = std::move(other.scratch);
+
+         other.chunks.clear();
+         other.current = 0;
+         other.used = 0;
+      }
+
+      return *this;
+   }
+
+   void rope::append(char const *data, std::size_t length)
+   {
+      while(length)
+      {
+         // fill the current chunk (or start a new one) with as much as fits
+         char *const target = tail();
+         std::size_t const count = std::min(length, space());
+
+         std::memcpy(target, data, count);
+         advance(count);
+
+         data += count;
+         length -= count;
+      }
+   }
+
+   auto rope::size() const -> std::size_t
+   {
+      return current * chunk_size + used;
+   }
+
+   auto rope::empty() const -> bool
+   {
+      return !current && !used;
+   }
+
+   auto rope::to_string() const -> std::string
+   {
+      std::string result;
+      result.reserve(size());
+
+      for(std::size_t i = 0; i < current; ++i)
+      {
+         result.append(chunks[i].get(), chunk_size);
+      }
+
+      if(used)
+      {
+         result.append(chunks[current].get(), used);
+      }
+
+      return result;
+   }
+
+   void rope::write_to(int fd) const
+   {
+#ifdef IOV_MAX
+      std::size_t const max_vectors = IOV_MAX;
+#else
+      std::size_t const max_vectors = 1024;
+#endif
+
+      // one vector per chunk in use
+      std::vector<iovec> vectors;
+      vectors.reserve(current + 1);
+
+      for(std::size_t i = 0; i < current; ++i)
+      {
+         vectors.push_back({chunks[i].get(), chunk_size});
+      }
+
+      if(used)
+      {
+         vectors.push_back({chunks[current].get(), used});
+      }
+
+      std::size_t first = 0;
+
+      while(first < vectors.size())
+      {
+         auto const count = static_cast<int>(std::min(vectors.size() - first, max_vectors));
+         ssize_t written = ::writev(fd, &vectors[first], count);
+
+         if(written < 0)
+         {
+            if(errno == EINTR) continue;
+
+            throw std::system_error(errno, std::system_category(), "rope::write_to");
+         }
+
+         // skip the vectors which were written completely, then trim the one which was written partially
+         while(first < vectors.size() && static_cast<std::size_t>(written) >= vectors[first].iov_len)
+         {
+            written -= static_cast<ssize_t>(vectors[first].iov_len);
+            ++first;
+         }
+
+         if(written > 0)
+         {
+            vectors[first].iov_base = static_cast<char *>(vectors[first].iov_base) + written;
+            vectors[first].iov_len -= static_cast<std::size_t>(written);
+         }
+      }
+   }
+
+   void rope::clear()
+   {
+      current = 0;
+      used = 0;
+   }
+
+   auto rope::space() const -> std::size_t
+   {
+      return current < chunks.size() ? chunk_size - used : 0;
+   }
+
+   auto rope::tail() -> char *
+   {
+      if(current == chunks.size())
+      {
+         chunks.emplace_back(new char[chunk_size]);
+      }
+
+      return chunks[current].get() + used;
+   }
+
+   void rope::advance(std::size_t length)
+   {
+      used += length;
+
+      if(used == chunk_size)
+      {
+         ++current;
+         used = 0;
+      }
+   }
+
+   auto rope::next_chunk() -> char *
+   {
+      if(current + 1 == chunks.size())
+      {
+         chunks.emplace_back(new char[chunk_size]);
+      }
+
+      return chunks[current + 1].get();
+   }
+
+   void rope::straddle(std::size_t length)
+   {
+      char *const next = chunks[current + 1].get();
+      std::size_t const head = space();
+
+      std::memcpy(chunks[current].get() + used, next, head);
+      std::memmove(next, next + head, length - head);
+
+      ++current;
+      used = length - head;
+   }
+
+   auto operator<<(rope &r, char const *t) -> rope &
+   {
+      r.append(t, std::strlen(t));
+      return r;
+   }
+
+   auto operator<<(rope &r, std::string const &t) -> rope &
+   {
+      r.append(t.data(), t.size());
+      return r;
+   }
+
+   auto operator<<(rope &r, char t) -> rope &
+   {
+      r.append(&t, 1);
+      return r;
+   }
+}
+
+#ifdef MDT_SELF_TEST
+
+// mdt::thread_alloc_counts()
+#include "alloc_tracker.hpp"
+
+// std::FILE, std::tmpfile(), std::fread(), std::rewind(), std::fclose()
+#include <cstdio>
+
+// fileno()
+#include <stdio.h>
+
+namespace mdt { namespace test { namespace rope
+{
+   auto all() -> result
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
+
+      test::result result{"rope tests"};
+
+      std::string const expected{"HELLO, C++11 0x00ff 2.5|  x|"};
+
+      /**
+       * (1) Ensure that the operator<< overloads write the same text as into a std::string, even across tiny chunks.
+       */
+      {
+         mdt::rope r(4);
+
+         r << "HELLO, C" << '+' << static_cast<uint8_t>('+') << 1 << std::string("1") << ' ' << "0x" << mdt::hex(255, 4) << ' ' << 2.5
+           << (mdt::str_builder() << '|' << mdt::pad('x', 3) << '|');
+
+         result << test::result{"concatenation across chunks", r.to_string() == expected && r.size() == expected.size()};
+      }
+
+      /**
+       * (2) Ensure that a cleared rope can be re-used, and that rvalue ropes work.
+       */
+      {
+         mdt::rope r(8);
+
+         r << std::string(100, 'x');
+         r.clear();
+         r << "abc";
+
+         result << test::result{"clear -> append = only new contents", r.to_string() == "abc"};
+         result << test::result{"rvalue concatenation", (mdt::rope() << "a" << 1 << 'b').to_string() == "a1b"};
+
+         mdt::rope moved{std::move(r)};
+         r << "defg";
+
+         mdt::rope assigned(8);
+         assigned << "xyz";
+         assigned = std::move(moved);
+         moved << 'h';
+
+         result << test::result
+         {
+            "moved-from ropes -> empty and re-usable",
+            r.to_string() == "defg" && r.size() == 4 && moved.to_string() == "h" && assigned.to_string() == "abc" && assigned.size() == 3
+         };
+      }
+
+      /**
+       * (3) Ensure that pieces longer than the stack buffer are split across chunks without a temporary string, and still written correctly
+       *     when they are longer than a chunk.
+       */
+      {
+         mdt::rope r(128);
+         std::string const long_text(100, 'y');
+         mdt::alloc_counts made{0, 0, 0, 0};
+
+         // the first round allocates both chunks; clear() keeps them, so the second round must not allocate at all
+         for(int round = 0; round < 2; ++round)
+         {
+            r.clear();
+
+            auto const before = mdt::thread_alloc_counts();
+            r << "0123456789" << (mdt::str_builder() << long_text) << (mdt::str_builder() << long_text);
+            made = mdt::thread_alloc_counts() - before;
+         }
+
+         mdt::rope small(16);
+         small << "abc" << (mdt::str_builder() << long_text << long_text);
+
+         result << test::result{"large piece across chunks -> no allocations", r.to_string() == "0123456789" + long_text + long_text && made.allocations == 0};
+         result << test::result{"piece larger than a chunk", small.to_string() == "abc" + long_text + long_text};
+      }
+
+      /**
+       * (4) Ensure that write_to() writes every chunk to the file descriptor in order.
+       */
+      {
+         mdt::rope r(16);
+
+         for(int i = 0; i < 1000; ++i)
+         {
+            r << i << ',';
+         }
+
+         std::string const contents = r.to_string();
+         std::string read_back(contents.size(), '\0');
+
+         std::FILE *file = std::tmpfile();
+         bool written = false;
+
+         if(file)
+         {
+            r.write_to(fileno(file));
+            std::rewind(file);
+
+            written = std::fread(&read_back[0], 1, read_back.size(), file) == read_back.size() && read_back == contents;
+
+            std::fclose(file);
+         }
+
+         result << test::result{"write_to() = contents", written};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
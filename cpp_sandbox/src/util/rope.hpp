@@ -0,0 +1,177 @@
+#ifndef ROPE_HPP_
+#define ROPE_HPP_
+
+// std::size_t
+#include <cstddef>
+
+// std::unique_ptr
+#include <memory>
+
+// std::string
+#include <string>
+
+// std::vector
+#include <vector>
+
+// mdt::str_piece, mdt::str_builder_node
+#include "string.hpp"
+
+namespace mdt
+{
+   /**
+    * String builder which appends into a list of fixed-size chunks instead of one contiguous buffer, so growing it never copies what has already
+    * been written. The result can be written to a file descriptor with writev(), without ever being assembled into a single string.
+    */
+   class rope
+   {
+      // create an empty rope which allocates chunks of 'chunk_size' bytes as it grows
+      public: explicit rope(std::size_t chunk_size = 64 * 1024);
+
+      // disallow copying via copy constructor
+      public: rope(rope const &) = delete;
+
+      // disallow copying via assignment operator
+      public: rope & operator=(rope const &) = delete;
+
+      // move via constructor operator, leaving 'other' empty (and usable)
+      public: rope(rope &&other);
+
+      // move via assignment operator, leaving 'other' empty (and usable)
+      public: rope & operator=(rope &&other);
+
+      // default destructor
+      public: ~rope() = default;
+
+      // copy 'length' bytes onto the end of the rope, spilling into new chunks as needed
+      public: void append(char const *data, std::size_t length);
+
+      // write one str_piece onto the end of the rope, directly into the current chunk whenever it fits
+      public: template<typename Piece> void append_piece(Piece const &piece)
+      {
+         std::size_t const length = piece.size();
+
+         if(!length)
+         {
+            return;
+         }
+
+         char *const target = tail();
+
+         if(length <= space())
+         {
+            piece.write(target);
+            advance(length);
+         }
+         else if(length <= SMALL_PIECE)
+         {
+            // small pieces which straddle two chunks are formatted on the stack and then split
+            char buffer[SMALL_PIECE];
+            piece.write(buffer);
+            append(buffer, length);
+         }
+         else if(length <= chunk_size)
+         {
+            // larger pieces are formatted at the start of the next chunk, and their head is then moved to the end of the current one
+            piece.write(next_chunk());
+            straddle(length);
+         }
+         else
+         {
+            // pieces larger than a chunk are formatted into a buffer which is kept for re-use, and then split
+            scratch.resize(length);
+            piece.write(&scratch[0]);
+            append(scratch.data(), length);
+         }
+      }
+
+      // return the number of bytes in the rope
+      public: auto size() const -> std::size_t;
+
+      // return true if the rope holds no bytes
+      public: auto empty() const -> bool;
+
+      // return a copy of the contents as a single string
+      public: auto to_string() const -> std::string;
+
+      // write the contents to the file descriptor with as few writev() calls as possible; throws std::system_error if writing fails
+      public: void write_to(int fd) const;
+
+      // empty the rope, keeping its chunks for re-use
+      public: void clear();
+
+      // return the number of free bytes in the current chunk
+      private: auto space() const -> std::size_t;
+
+      // return the position of the next byte in the current chunk, allocating a chunk if there is none
+      private: auto tail() -> char *;
+
+      // mark 'length' more bytes of the current chunk as used, moving to the next chunk once it is full
+      private: void advance(std::size_t length);
+
+      // return the start of the chunk after the current one (which must exist), allocating it if there is none
+      private: auto next_chunk() -> char *;
+
+      // complete a piece of 'length' bytes (more than space()) written by next_chunk(): fill the current chunk with its head, move its tail to
+      // the start of the next chunk, and continue after it
+      private: void straddle(std::size_t length);
+
+      // largest piece formatted on the stack when it does not fit in the current chunk
+      private: static constexpr std::size_t SMALL_PIECE = 64;
+
+      // size of every chunk
+      private: std::size_t chunk_size;
+
+      // every chunk allocated so far; the ones after 'current' are spares left over from before clear()
+      private: std::vector<std::unique_ptr<char[]>> chunks;
+
+      // index of the chunk being written
+      private: std::size_t current;
+
+      // number of bytes used in the chunk being written
+      private: std::size_t used;
+
+      // formats pieces which are larger than a chunk; kept so that only the first such piece allocates
+      private: std::string scratch;
+   };
+
+   // append a C-string to an lvalue-rope
+   auto operator<<(rope &r, char const *t) -> rope &;
+
+   // append a std::string to an lvalue-rope
+   auto operator<<(rope &r, std::string const &t) -> rope &;
+
+   // append a character to an lvalue-rope
+   auto operator<<(rope &r, char t) -> rope &;
+
+   // append any type supported by the std::string operator<< overloads to an lvalue-rope
+   template<typename T> auto operator<<(rope &r, T const &t) -> rope &
+   {
+      r.append_piece(str_piece<typename std::decay<T const>::type>(t));
+      return r;
+   }
+
+   // append a whole str_builder chain to an lvalue-rope
+   template<typename Prev, typename T> auto operator<<(rope &r, str_builder_node<Prev, T> const &b) -> rope &
+   {
+      r.append_piece(b);
+      return r;
+   }
+
+   // append anything supported above to an rvalue-rope
+   template<typename T> auto operator<<(rope &&r, T const &t) -> rope &&
+   {
+      return std::move(r << t);
+   }
+}
+
+#ifdef MDT_SELF_TEST
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace rope
+{
+   // run all rope tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* ROPE_HPP_ */
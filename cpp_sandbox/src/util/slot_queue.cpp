@@ -0,0 +1,157 @@
+#ifdef MDT_SELF_TEST
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// std::runtime_error
+#include <stdexcept>
+
+// std::string
+#include <string>
+
+// mdt::thread_alloc_counts()
+#include "alloc_tracker.hpp"
+
+// mdt::slot_queue
+#include "slot_queue.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// test interface ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt { namespace test { namespace slot_queue
+{
+   // counts its live instances, so that tests can tell whether every element was destroyed
+   struct counted
+   {
+      explicit counted(int &live) : live(&live) { ++live; }
+      counted(counted const &other) : live(other.live) { ++*live; }
+      ~counted() { --*live; }
+
+      int *live;
+   };
+
+   // throws from its constructor when asked to
+   struct fragile
+   {
+      explicit fragile(int value) : value(value) { if(value < 0) throw std::runtime_error("fragile"); }
+
+      int value;
+   };
+
+   auto all() -> result
+   {
+      test::result result{"slot_queue tests"};
+
+      /**
+       * (1) Ensure that elements come out in the order they went in, across several blocks, and that the front element never moves.
+       */
+      {
+         mdt::slot_queue<std::string, 4> q;
+
+         q.push("first");
+         std::string const *front = &q.front();
+
+         bool stable = true;
+
+         for(int i = 0; i < 20; ++i)
+         {
+            q.emplace(3, static_cast<char>('a' + i));
+            stable = stable && &q.front() == front;
+         }
+
+         bool ordered = q.size() == 21 && q.front() == "first";
+         q.pop();
+
+         for(int i = 0; i < 20; ++i, q.pop())
+         {
+            ordered = ordered && q.front() == std::string(3, static_cast<char>('a' + i));
+         }
+
+         result << test::result{"FIFO order across blocks", ordered && q.empty()};
+         result << test::result{"front element does not move while pushing", stable};
+      }
+
+      /**
+       * (2) Ensure that used-up blocks are recycled, so that a queue which stays within its working depth stops allocating.
+       */
+      {
+         mdt::slot_queue<int, 8> q;
+
+         auto cycle = [&q]
+         {
+            for(int i = 0; i < 100; ++i) q.push(i);
+            for(int i = 0; i < 100; ++i) q.pop();
+         };
+
+         cycle();
+
+         auto const before = mdt::thread_alloc_counts();
+
+         for(int i = 0; i < 10; ++i) cycle();
+
+         auto const made = mdt::thread_alloc_counts() - before;
+
+         result << test::result{"warmed-up queue -> no allocations", made.allocations == 0};
+      }
+
+      /**
+       * (3) Ensure that every element is destroyed exactly once, whether popped, left in the queue, or moved into another queue.
+       */
+      {
+         int live = 0;
+
+         {
+            mdt::slot_queue<counted, 4> q;
+
+            for(int i = 0; i < 10; ++i) q.emplace(live);
+            for(int i = 0; i < 3; ++i) q.pop();
+
+            mdt::slot_queue<counted, 4> moved{std::move(q)};
+
+            moved.push(counted{live});
+
+            result << test::result{"moved queue -> same elements", live == 8 && moved.size() == 8 && q.empty()};
+         }
+
+         result << test::result{"destruction -> elements destroyed", live == 0};
+      }
+
+      /**
+       * (4) Ensure that a throwing constructor leaves the queue as it was, including when it is the first element of a new block.
+       */
+      {
+         mdt::slot_queue<fragile, 4> q;
+
+         for(int i = 0; i < 4; ++i) q.emplace(i);
+
+         bool thrown = false;
+
+         try
+         {
+            q.emplace(-1);
+         }
+         catch(std::runtime_error const &)
+         {
+            thrown = true;
+         }
+
+         bool const unchanged = thrown && q.size() == 4 && q.front().value == 0;
+
+         while(!q.empty()) q.pop();
+
+         q.emplace(42);
+
+         result << test::result{"throwing constructor -> queue unchanged", unchanged};
+         result << test::result{"throwing constructor -> drain -> emplace = new front", q.size() == 1 && q.front().value == 42};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
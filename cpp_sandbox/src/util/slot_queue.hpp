@@ -0,0 +1,266 @@
+#ifndef SLOT_QUEUE_HPP_
+#define SLOT_QUEUE_HPP_
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                  Includes                                                                     ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// std::size_t
+#include <cstddef>
+
+// placement new
+#include <new>
+
+// std::aligned_storage
+#include <type_traits>
+
+// std::forward(), std::swap()
+#include <utility>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                             slot_queue Definition                                                             ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace mdt
+{
+   /**
+    * Single-threaded FIFO queue of elements stored in blocks of raw slots. Elements are constructed in place and never move until they are popped,
+    * so a reference to the front element stays valid while more elements are pushed. Blocks which have been emptied are kept for re-use instead of
+    * being freed, so once the queue has grown to its working depth, pushing and popping no longer allocate (unlike std::deque, which frees and
+    * allocates a block every few hundred bytes as it advances).
+    */
+   template<class T, std::size_t BlockSlots = 64>
+   class slot_queue
+   {
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Type Definitions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // stored element type, provided for cases in which the type is difficult to deduce
+      public: typedef T element_type;
+
+      // the type of this templated class, provided for cases in which the type is difficult to deduce
+      public: typedef slot_queue<element_type, BlockSlots> class_type;
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Functions ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // construct an empty queue; no block is allocated until the first push
+      public: slot_queue()
+         :
+         head{nullptr},
+         tail{nullptr},
+         spare{nullptr},
+         head_index{0},
+         tail_index{0},
+         count{0}
+      {}
+
+      // disallow copying via copy constructor
+      public: slot_queue(class_type const &) = delete;
+
+      // disallow copying via assignment operator
+      public: class_type & operator=(class_type const &) = delete;
+
+      // move via move constructor, leaving 'other' empty
+      public: slot_queue(class_type &&other)
+         :
+         slot_queue{}
+      {
+         swap(other);
+      }
+
+      // disallow move via assignment operator
+      public: class_type & operator=(class_type &&) = delete;
+
+      // destroy the remaining elements and free every block
+      public: ~slot_queue()
+      {
+         while(count) pop();
+
+         free_blocks(head);
+         free_blocks(spare);
+      }
+
+      // construct an element in place at the back of the queue; if the constructor throws, the queue is left as it was
+      public: template<typename... Args> void emplace(Args &&... args)
+      {
+         // move on to a new block once the current one is full, but only link it into the queue once its first element has been constructed
+         block *next = !tail || tail_index == BlockSlots ? take_block() : nullptr;
+
+         try
+         {
+            new(next ? &next->slots[0] : &tail->slots[tail_index]) element_type(std::forward<Args>(args)...);
+         }
+         catch(...)
+         {
+            if(next)
+            {
+               next->next = spare;
+               spare = next;
+            }
+
+            throw;
+         }
+
+         if(next)
+         {
+            (tail ? tail->next : head) = next;
+            tail = next;
+            tail_index = 0;
+         }
+
+         ++tail_index;
+         ++count;
+      }
+
+      // move an element onto the back of the queue
+      public: void push(element_type &&element)
+      {
+         emplace(std::move(element));
+      }
+
+      // copy an element onto the back of the queue
+      public: void push(element_type const &element)
+      {
+         emplace(element);
+      }
+
+      // return the oldest element; the queue must not be empty
+      public: auto front() -> element_type &
+      {
+         return *reinterpret_cast<element_type *>(&head->slots[head_index]);
+      }
+
+      // destroy the oldest element; the queue must not be empty
+      public: void pop()
+      {
+         front().~element_type();
+
+         ++head_index;
+         --count;
+
+         if(!count)
+         {
+            // the queue is empty, so head and tail share a block which can be written again from its start
+            head_index = tail_index = 0;
+         }
+         else if(head_index == BlockSlots)
+         {
+            // the head block has been used up; keep it for re-use
+            block *used = head;
+
+            head = head->next;
+            head_index = 0;
+
+            used->next = spare;
+            spare = used;
+         }
+      }
+
+      // return true if the queue holds no elements
+      public: auto empty() const -> bool
+      {
+         return !count;
+      }
+
+      // return the number of elements in the queue
+      public: auto size() const -> std::size_t
+      {
+         return count;
+      }
+
+      // exchange the contents (including spare blocks) of the two queues
+      public: void swap(class_type &other)
+      {
+         std::swap(head, other.head);
+         std::swap(tail, other.tail);
+         std::swap(spare, other.spare);
+         std::swap(head_index, other.head_index);
+         std::swap(tail_index, other.tail_index);
+         std::swap(count, other.count);
+      }
+
+      // a block of raw slots, linked to the next block of the queue (or of the spares)
+      private: struct block
+      {
+         typename std::aligned_storage<sizeof(element_type), alignof(element_type)>::type slots[BlockSlots];
+         block *next;
+      };
+
+      // return a spare block, or a new one if there are none
+      private: auto take_block() -> block *
+      {
+         block *result = spare;
+
+         if(result)
+         {
+            spare = spare->next;
+         }
+         else
+         {
+            result = new block;
+         }
+
+         result->next = nullptr;
+
+         return result;
+      }
+
+      // free a list of blocks (whose elements have already been destroyed)
+      private: static void free_blocks(block *list)
+      {
+         while(list)
+         {
+            block *next = list->next;
+            delete list;
+            list = next;
+         }
+      }
+
+
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// Variables ///
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+      // the block holding the oldest element, and the block into which elements are pushed (the same block when the queue is short)
+      private: block *head;
+      private: block *tail;
+
+      // emptied blocks kept for re-use
+      private: block *spare;
+
+      // slot of the oldest element within 'head', and the next free slot within 'tail'
+      private: std::size_t head_index;
+      private: std::size_t tail_index;
+
+      // number of elements in the queue
+      private: std::size_t count;
+   };
+}
+
+#ifdef MDT_SELF_TEST
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///                                                                                                                                               ///
+///                                                                    Self-Tests                                                                 ///
+///                                                                                                                                               ///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// mdt::test::result
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace slot_queue
+{
+   // run all slot_queue self-tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* SLOT_QUEUE_HPP_ */
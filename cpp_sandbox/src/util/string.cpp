@@ -1,3 +1,9 @@
+// std::memchr(), std::memcpy()
+#include <cstring>
+
+// std::less
+#include <functional>
+
 // string helper functions
 #include "string.hpp"
 
@@ -44,9 +50,271 @@ namespace mdt
    }
 }
 
+// SSE2 and AVX2 intrinsics, where the compiler can target them function by function
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define MDT_STRING_SIMD
+#include <immintrin.h>
+#endif
+
+namespace mdt
+{
+   // bytes which must be escaped in a JSON string: control characters, quotation marks and backslashes
+   struct json_specials
+   {
+      static auto test(char c) -> bool
+      {
+         return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+      }
+
+#ifdef MDT_STRING_SIMD
+      static auto test(__m128i v) -> __m128i
+      {
+         __m128i const control = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f));
+         return _mm_or_si128(control, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+      }
+
+      __attribute__((target("avx2"))) static auto test(__m256i v) -> __m256i
+      {
+         __m256i const control = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1f)), _mm256_set1_epi8(0x1f));
+         return _mm256_or_si256(control, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
+      }
+#endif
+   };
+
+   // bytes which make a CSV field need quoting: commas, quotation marks, CR and LF
+   struct csv_specials
+   {
+      static auto test(char c) -> bool
+      {
+         return c == ',' || c == '"' || c == '\r' || c == '\n';
+      }
+
+#ifdef MDT_STRING_SIMD
+      static auto test(__m128i v) -> __m128i
+      {
+         return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')), _mm_cmpeq_epi8(v, _mm_set1_epi8('"'))),
+                             _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+      }
+
+      __attribute__((target("avx2"))) static auto test(__m256i v) -> __m256i
+      {
+         return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+      }
+#endif
+   };
+
+   // return the first byte in [p, end) which belongs to 'Specials', or 'end' if there is none, testing one byte at a time
+   template<class Specials>
+   static auto scan_scalar(char const *p, char const *end) -> char const *
+   {
+      while(p != end && !Specials::test(*p))
+      {
+         ++p;
+      }
+
+      return p;
+   }
+
+#ifdef MDT_STRING_SIMD
+   // scan_scalar() testing 16 bytes at a time
+   template<class Specials>
+   static auto scan_sse2(char const *p, char const *end) -> char const *
+   {
+      for(; end - p >= 16; p += 16)
+      {
+         int const found = _mm_movemask_epi8(Specials::test(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p))));
+
+         if(found)
+         {
+            return p + __builtin_ctz(static_cast<unsigned>(found));
+         }
+      }
+
+      return scan_scalar<Specials>(p, end);
+   }
+
+   // scan_scalar() testing 32 bytes at a time
+   template<class Specials>
+   __attribute__((target("avx2"))) static auto scan_avx2(char const *p, char const *end) -> char const *
+   {
+      for(; end - p >= 32; p += 32)
+      {
+         int const found = _mm256_movemask_epi8(Specials::test(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p))));
+
+         if(found)
+         {
+            return p + __builtin_ctz(static_cast<unsigned>(found));
+         }
+      }
+
+      return scan_sse2<Specials>(p, end);
+   }
+#endif
+
+   // return the first byte in [p, end) which belongs to 'Specials', using the widest kernel the processor supports
+   template<class Specials>
+   static auto scan(char const *p, char const *end) -> char const *
+   {
+#ifdef MDT_STRING_SIMD
+      // checked once; the function-local static makes the check thread-safe
+      static bool const avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+
+      return avx2 ? scan_avx2<Specials>(p, end) : scan_sse2<Specials>(p, end);
+#else
+      return scan_scalar<Specials>(p, end);
+#endif
+   }
+
+   // return the number of characters which replace a byte belonging to json_specials
+   static auto json_escaped_size(char c) -> std::size_t
+   {
+      return (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t') ? 2 : 6;
+   }
+
+   // write the replacement of a byte belonging to json_specials and return the position just past it
+   static auto write_json_escaped(char *out, char c) -> char *
+   {
+      static char const HEX_DIGITS[] = "0123456789abcdef";
+
+      *out++ = '\\';
+
+      switch(c)
+      {
+         case '"':  *out++ = '"';  break;
+         case '\\': *out++ = '\\'; break;
+         case '\n': *out++ = 'n';  break;
+         case '\r': *out++ = 'r';  break;
+         case '\t': *out++ = 't';  break;
+         default:
+            *out++ = 'u';
+            *out++ = '0';
+            *out++ = '0';
+            *out++ = HEX_DIGITS[static_cast<unsigned char>(c) >> 4];
+            *out++ = HEX_DIGITS[static_cast<unsigned char>(c) & 0xf];
+      }
+
+      return out;
+   }
+
+   // grow the string by 'extra' characters and return where 'text' is afterwards, since it may point into the string's own (reallocated) buffer
+   static auto grow(std::string &s, std::size_t extra, char const *text) -> char const *
+   {
+      std::less<char const *> const before;
+      char const *const data = s.data();
+
+      if(before(text, data) || !before(text, data + s.size()))
+      {
+         s.resize(s.size() + extra);
+         return text;
+      }
+
+      std::size_t const position = static_cast<std::size_t>(text - data);
+
+      s.resize(s.size() + extra);
+      return s.data() + position;
+   }
+
+   void append_json_escaped(std::string &s, char const *text, std::size_t length)
+   {
+      if(!length)
+      {
+         return;
+      }
+
+      char const *end = text + length;
+
+      // measure: every byte is copied, and each special byte grows into its escape sequence
+      std::size_t size = length;
+
+      for(char const *p = scan<json_specials>(text, end); p != end; p = scan<json_specials>(p + 1, end))
+      {
+         size += json_escaped_size(*p) - 1;
+      }
+
+      std::size_t const offset = s.size();
+
+      text = grow(s, size, text);
+      end = text + length;
+
+      // write: copy each run of ordinary bytes in one go, followed by the escape sequence which ends it
+      char *out = &s[offset];
+
+      for(char const *p = text; ; ++p)
+      {
+         char const *const special = scan<json_specials>(p, end);
+
+         std::memcpy(out, p, static_cast<std::size_t>(special - p));
+         out += special - p;
+
+         if(special == end)
+         {
+            break;
+         }
+
+         out = write_json_escaped(out, *special);
+         p = special;
+      }
+   }
+
+   void append_csv_escaped(std::string &s, char const *text, std::size_t length)
+   {
+      char const *end = text + length;
+
+      // most fields need no quoting and are copied as they are
+      if(scan<csv_specials>(text, end) == end)
+      {
+         s.append(text, length);
+         return;
+      }
+
+      // measure: the enclosing quotation marks, plus one more for each one inside the field
+      std::size_t size = length + 2;
+
+      for(char const *p = text; (p = static_cast<char const *>(std::memchr(p, '"', static_cast<std::size_t>(end - p)))); ++p)
+      {
+         ++size;
+      }
+
+      std::size_t const offset = s.size();
+
+      text = grow(s, size, text);
+      end = text + length;
+
+      // write: copy each run up to and including a quotation mark in one go, then double the quotation mark
+      char *out = &s[offset];
+
+      *out++ = '"';
+
+      for(char const *p = text; p != end; )
+      {
+         char const *quote = static_cast<char const *>(std::memchr(p, '"', static_cast<std::size_t>(end - p)));
+         char const *const stop = quote ? quote + 1 : end;
+
+         std::memcpy(out, p, static_cast<std::size_t>(stop - p));
+         out += stop - p;
+
+         if(quote)
+         {
+            *out++ = '"';
+         }
+
+         p = stop;
+      }
+
+      *out = '"';
+   }
+}
+
 #ifdef MDT_SELF_TEST
 #include <iostream>
 
+// std::list
+#include <list>
+
+// std::vector
+#include <vector>
+
 namespace mdt { namespace test { namespace string
 {
    static const std::string TEST_STRING{"HELLO, C++11"};
@@ -84,7 +352,281 @@ namespace mdt { namespace test { namespace string
          };
       }
 
+      /**
+       * (3) Ensure that presized concatenation produces the same string as operator<<.
+       */
+      {
+         result << test::result{"concat()", mdt::concat("HELLO, C", '+', static_cast<uint8_t>('+'), 1, std::string("1")) == TEST_STRING};
+
+         // establish an lvalue which already holds the start of the string
+         std::string lvalue{"HELLO"};
+
+         mdt::append(lvalue, ", C", '+', static_cast<uint8_t>('+'), 1u, 1L);
+
+         result << test::result{"append()", lvalue == TEST_STRING};
+      }
+
+      /**
+       * (4) Ensure that str_builder chains produce the same string as operator<<, whether appended or converted.
+       */
+      {
+         std::string lvalue;
+
+         lvalue << (mdt::str_builder() << "HELLO, C" << '+' << static_cast<uint8_t>('+') << 1 << std::string("1"));
+
+         std::string const converted = mdt::str_builder() << "HELLO, C" << '+' << static_cast<uint8_t>('+') << 1 << std::string("1");
+
+         result << test::result{"str_builder appended to an lvalue", lvalue == TEST_STRING};
+         result << test::result{"str_builder converted to std::string", converted == TEST_STRING};
+      }
+
+      /**
+       * (5) Ensure that presized integer formatting handles signs and extremes, and that a string can be appended to itself, including through
+       *     C-strings which point into it while it grows (in place, out of its short-string buffer, and out of a full heap buffer).
+       */
+      {
+         result << test::result
+         {
+            "integer extremes",
+            mdt::concat(INT64_MIN, ' ', UINT64_MAX, ' ', 0, ' ', -7) == "-9223372036854775808 18446744073709551615 0 -7"
+         };
+
+         std::string lvalue{"ab"};
+
+         mdt::append(lvalue, lvalue, lvalue);
+
+         result << test::result{"append() of the string to itself", lvalue == "ababab"};
+
+         std::string small{"abc"};
+         mdt::append(small, small.c_str(), '-', small.data() + 1, 0);
+
+         std::string large(40, 'x');
+         large.shrink_to_fit();
+         mdt::append(large, large.c_str(), large.c_str() + 38, 1);
+
+         std::string built{"abcd"};
+         built << (mdt::str_builder() << built.c_str() << built.c_str() + 2 << built.c_str() << built.c_str());
+
+         result << test::result
+         {
+            "append() of C-strings pointing into the string",
+            small == "abcabc-bc0" && large == std::string(80, 'x') + "xx1" && built == "abcdabcdcdabcdabcd"
+         };
+      }
+
+      /**
+       * (6) Ensure that numbers are written without std::to_string(): floating-point values in shortest form, plus the manipulators.
+       */
+      {
+         std::string lvalue;
+
+         lvalue << 0.1 << ' ' << 2.5f << ' ' << -1e100 << ' ' << true;
+
+         result << test::result{"shortest floating-point concatenation", lvalue == "0.1 2.5 -1e+100 1"};
+
+         result << test::result
+         {
+            "number manipulators",
+            (std::string() << mdt::hex(255) << ' ' << mdt::hex(-1, 4) << ' ' << mdt::hex(uint8_t{10}, 2)) == "ff ffffffff 0a" &&
+            (std::string() << mdt::pad(42, 6, '0') << '|' << mdt::pad("ab", 4) << '|' << mdt::pad(TEST_STRING, 2)) == "000042|  ab|" + TEST_STRING &&
+            (std::string() << mdt::fixed(3.14159, 3) << ' ' << mdt::pad(mdt::fixed(2.5, 1), 6, '*')) == "3.142 ***2.5" &&
+            mdt::concat(mdt::hex(0xbeefu, 8), ' ', mdt::fixed(1.0, 0)) == "0000beef 1"
+         };
+      }
+
+      /**
+       * (7) Ensure that join() separates the elements of any range, including empty ones, and writes nothing for an empty range.
+       */
+      {
+         std::vector<std::string> const words{"alpha", "", "gamma"};
+         std::list<int> const numbers{-1, 20, 300};
+
+         result << test::result
+         {
+            "join()",
+            mdt::join(words, ", ") == "alpha, , gamma" && mdt::join(numbers, '|') == "-1|20|300" && mdt::join(std::vector<int>{}, ", ").empty() &&
+            mdt::join(std::vector<std::string>{"one"}, std::string("--")) == "one"
+         };
+      }
+
+      /**
+       * (8) Ensure that JSON escaping handles every kind of special byte (including when a string is escaped onto itself), and that the SSE2 and AVX2
+       *     kernels find the same bytes as the scalar one at every length and alignment.
+       */
+      {
+         std::string escaped{"\""};
+
+         mdt::append_json_escaped(escaped, std::string("say \"hi\"\\\n\r\t\x01\x1f caf\xc3\xa9", 20));
+         escaped << '"';
+
+         result << test::result{"append_json_escaped()", escaped == "\"say \\\"hi\\\"\\\\\\n\\r\\t\\u0001\\u001f caf\xc3\xa9\""};
+
+         // long enough to be scanned by the vector kernels, and grown past its capacity
+         std::string self(40, 'x');
+         self << "\"\n";
+         self.shrink_to_fit();
+
+         std::string const original = self;
+         std::string expected = original;
+         mdt::append_json_escaped(expected, original);
+
+         mdt::append_json_escaped(self, self);
+
+         result << test::result{"append_json_escaped() of the string to itself", self == expected};
+
+         // mostly ordinary bytes, with a special byte every now and then
+         std::string text(200, 'x');
+
+         for(std::size_t i = 0; i < text.size(); i += 37)
+         {
+            text[i] = "\"\\\n\x02,"[i % 5];
+         }
+
+         bool agree = true;
+
+         for(std::size_t begin = 0; begin < 40; ++begin)
+         {
+            for(std::size_t end = begin; end <= text.size(); ++end)
+            {
+               char const *const p = text.data() + begin;
+               char const *const e = text.data() + end;
+               char const *const json = mdt::scan_scalar<mdt::json_specials>(p, e);
+               char const *const csv = mdt::scan_scalar<mdt::csv_specials>(p, e);
+
+#ifdef MDT_STRING_SIMD
+               agree = agree && mdt::scan_sse2<mdt::json_specials>(p, e) == json && mdt::scan_sse2<mdt::csv_specials>(p, e) == csv;
+
+               if(__builtin_cpu_supports("avx2"))
+               {
+                  agree = agree && mdt::scan_avx2<mdt::json_specials>(p, e) == json && mdt::scan_avx2<mdt::csv_specials>(p, e) == csv;
+               }
+#endif
+               agree = agree && mdt::scan<mdt::json_specials>(p, e) == json && mdt::scan<mdt::csv_specials>(p, e) == csv;
+            }
+         }
+
+         result << test::result{"vector kernels == scalar kernel", agree};
+      }
+
+      /**
+       * (9) Ensure that only CSV fields which need it are quoted, with their quotation marks doubled, including when a field is appended to itself.
+       */
+      {
+         std::string row;
+
+         for(auto const &field : {std::string("plain"), std::string("a,b"), std::string("say \"hi\""), std::string("two\nlines"), std::string()})
+         {
+            row << (row.empty() ? "" : ",");
+            mdt::append_csv_escaped(row, field);
+         }
+
+         result << test::result{"append_csv_escaped()", row == "plain,\"a,b\",\"say \"\"hi\"\"\",\"two\nlines\","};
+
+         std::string self(40, 'x');
+         self << "\",";
+         self.shrink_to_fit();
+
+         std::string const expected = self + "\"" + std::string(40, 'x') + "\"\",\"";
+
+         mdt::append_csv_escaped(self, self);
+
+         result << test::result{"append_csv_escaped() of the field to itself", self == expected};
+      }
+
       return result;
    }
 }}}
 #endif
+
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+
+// std::vector
+#include <vector>
+
+namespace mdt { namespace bench { namespace string
+{
+   void add_cases(suite &cases)
+   {
+      /**
+       * (1) Appending mixed pieces to a string whose capacity is already sufficient.
+       */
+      cases.add("operator<< into a reserved string", [](std::size_t iterations)
+      {
+         std::string s;
+         s.reserve(64);
+
+         for(std::size_t i = 0; i < iterations; ++i)
+         {
+            s.clear();
+            s << "id=" << i << " ratio=" << 0.25 << ' ' << mdt::hex(i, 8);
+            keep(s);
+         }
+      });
+
+      /**
+       * (2) Building a new string from mixed pieces with a single allocation.
+       */
+      cases.add("concat() into a new string", [](std::size_t iterations)
+      {
+         for(std::size_t i = 0; i < iterations; ++i)
+         {
+            auto const s = mdt::concat("tenant-", i, '/', mdt::fixed(1.5, 2), "/requests");
+            keep(s);
+         }
+      });
+
+      /**
+       * (3) Shortest round-trip formatting of floating-point values.
+       */
+      cases.add("operator<< of a double", [](std::size_t iterations)
+      {
+         std::string s;
+         s.reserve(64);
+
+         for(std::size_t i = 0; i < iterations; ++i)
+         {
+            s.clear();
+            s << static_cast<double>(i) * 1.1;
+            keep(s);
+         }
+      });
+
+      /**
+       * (4) Escaping a 4 KiB JSON string value with an occasional special byte.
+       */
+      cases.add("append_json_escaped() of 4 KiB", [](std::size_t iterations)
+      {
+         std::string text(4096, 'x');
+
+         for(std::size_t i = 0; i < text.size(); i += 200)
+         {
+            text[i] = '"';
+         }
+
+         std::string s;
+         s.reserve(2 * text.size());
+
+         for(std::size_t i = 0; i < iterations; ++i)
+         {
+            s.clear();
+            mdt::append_json_escaped(s, text);
+            keep(s);
+         }
+      });
+
+      /**
+       * (5) Joining a thousand short fields into one record.
+       */
+      cases.add("join() of 1000 fields", [](std::size_t iterations)
+      {
+         std::vector<std::string> fields(1000, "field");
+
+         for(std::size_t i = 0; i < iterations; ++i)
+         {
+            auto const s = mdt::join(fields, ", ");
+            keep(s);
+         }
+      });
+   }
+}}}
+#endif
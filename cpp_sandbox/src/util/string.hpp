@@ -1,9 +1,33 @@
 #ifndef STRING_HPP_
 #define STRING_HPP_
 
+// std::max()
+#include <algorithm>
+
+// std::size_t
+#include <cstddef>
+
+// uint8_t
+#include <cstdint>
+
+// std::memcpy(), std::memset(), std::strlen()
+#include <cstring>
+
+// std::begin()
+#include <iterator>
+
 // std::string
 #include <string>
 
+// std::decay(), std::enable_if(), std::is_integral(), std::is_floating_point(), std::make_unsigned(), std::conditional()
+#include <type_traits>
+
+// std::move()
+#include <utility>
+
+// mdt::format_decimal(), mdt::format_shortest(), mdt::format_hex(), mdt::format_fixed()
+#include "number_format.hpp"
+
 namespace mdt
 {
    // append a C-string to an rvalue-std::string
@@ -29,17 +53,440 @@ namespace mdt
 
    // append a character to an lvalue-std::string
    auto operator<<(std::string &s, uint8_t t) -> std::string &;
+}
+
+namespace mdt
+{
+   /**
+    * Adapter which knows the exact length of one piece of a concatenation before writing it, so that a whole concatenation can be sized up front
+    * and written with a single allocation. Each supported type provides a specialization with these members:
+    *
+    *    explicit str_piece(T const &t);         // capture (or format into a local buffer) the value
+    *    auto size() const -> std::size_t;      // return the number of characters write() will produce
+    *    auto write(char *out) const -> char *; // write the piece to 'out' and return the position just past it
+    */
+   template<typename T, typename Enable = void>
+   class str_piece;
+
+   // C-strings (and string literals, which decay to C-strings) are measured once and copied directly; they may point into the string being appended
+   // to, since its buffer is only replaced once every piece has been written (see append_buffer())
+   template<>
+   class str_piece<char const *>
+   {
+      public: explicit str_piece(char const *t) : text(t), length(std::strlen(t)) {}
+
+      public: auto size() const -> std::size_t { return length; }
+
+      public: auto write(char *out) const -> char * { std::memcpy(out, text, length); return out + length; }
+
+      private: char const *text;
+
+      private: std::size_t length;
+   };
+
+   // mutable C-strings are handled like constant ones
+   template<>
+   class str_piece<char *> : public str_piece<char const *>
+   {
+      public: explicit str_piece(char const *t) : str_piece<char const *>(t) {}
+   };
+
+   // std::strings are copied directly; the string is only read in write(), so appending a string to itself is safe
+   template<>
+   class str_piece<std::string>
+   {
+      public: explicit str_piece(std::string const &t) : text(t), length(t.size()) {}
+
+      public: auto size() const -> std::size_t { return length; }
+
+      public: auto write(char *out) const -> char * { std::memcpy(out, text.data(), length); return out + length; }
+
+      private: std::string const &text;
+
+      private: std::size_t length;
+   };
+
+   // single characters (including uint8_t, matching operator<< above)
+   template<typename T>
+   class str_piece<T, typename std::enable_if<std::is_same<T, char>::value || std::is_same<T, uint8_t>::value>::type>
+   {
+      public: explicit str_piece(T t) : c(static_cast<char>(t)) {}
+
+      public: auto size() const -> std::size_t { return 1; }
+
+      public: auto write(char *out) const -> char * { *out = c; return out + 1; }
+
+      private: char c;
+   };
+
+   // integers are formatted into a small local buffer instead of a temporary std::string
+   template<typename T>
+   class str_piece<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value && !std::is_same<T, uint8_t>::value>::type>
+   {
+      public: explicit str_piece(T t) : length(static_cast<std::size_t>(format(digits, t) - digits)) {}
+
+      public: auto size() const -> std::size_t { return length; }
+
+      public: auto write(char *out) const -> char * { std::memcpy(out, digits, length); return out + length; }
+
+      // signed values keep their sign
+      private: template<typename U> static auto format(char *out, U value) -> typename std::enable_if<std::is_signed<U>::value, char *>::type
+      {
+         return format_decimal(out, static_cast<long long>(value));
+      }
+
+      // unsigned values (including bool) are written as they are
+      private: template<typename U> static auto format(char *out, U value) -> typename std::enable_if<!std::is_signed<U>::value, char *>::type
+      {
+         return format_decimal(out, static_cast<unsigned long long>(value));
+      }
+
+      private: char digits[max_integer_chars];
+
+      private: std::size_t length;
+   };
+
+   // floating-point values are written in their shortest round-trip form (long double is narrowed to double)
+   template<typename T>
+   class str_piece<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+   {
+      public: explicit str_piece(T t) : length(static_cast<std::size_t>(format(digits, t) - digits)) {}
+
+      public: auto size() const -> std::size_t { return length; }
+
+      public: auto write(char *out) const -> char * { std::memcpy(out, digits, length); return out + length; }
+
+      private: static auto format(char *out, float value) -> char * { return format_shortest(out, value); }
+
+      private: static auto format(char *out, long double value) -> char * { return format_shortest(out, static_cast<double>(value)); }
+
+      private: static auto format(char *out, double value) -> char * { return format_shortest(out, value); }
+
+      private: char digits[max_shortest_chars];
+
+      private: std::size_t length;
+   };
+
+   // an integer to be written in lower-case hexadecimal, zero-padded to a minimum width; see hex()
+   template<typename T>
+   struct hex_format
+   {
+      T value;
+      unsigned width;
+   };
+
+   // a value to be right-aligned within a minimum width; see pad()
+   template<typename T>
+   struct padded
+   {
+      // scalars are held by value, everything else by reference (so the padded value must outlive the expression which writes it)
+      typename std::conditional<std::is_scalar<T>::value, T, T const &>::type value;
+      unsigned width;
+      char fill;
+   };
+
+   // a floating-point value to be written with a fixed number of digits after the point; see fixed()
+   struct fixed_format
+   {
+      double value;
+      unsigned precision;
+   };
+
+   // write an integer in lower-case hexadecimal, zero-padded to at least 'width' digits (negative values are written in two's complement)
+   template<typename T>
+   auto hex(T value, unsigned width = 0) -> hex_format<typename std::make_unsigned<T>::type>
+   {
+      return {static_cast<typename std::make_unsigned<T>::type>(value), width};
+   }
+
+   // write any supported value right-aligned within at least 'width' characters, filling the left side with 'fill'
+   template<typename T>
+   auto pad(T const &value, unsigned width, char fill = ' ') -> padded<typename std::decay<T const>::type>
+   {
+      return {value, width, fill};
+   }
+
+   // write a floating-point value with exactly 'precision' digits after the point
+   inline auto fixed(double value, unsigned precision) -> fixed_format
+   {
+      return {value, precision};
+   }
+
+   // hexadecimal integers are written straight into place
+   template<typename T>
+   class str_piece<hex_format<T>>
+   {
+      public: explicit str_piece(hex_format<T> const &t) : format(t), length(1)
+      {
+         for(T rest = static_cast<T>(t.value >> 4); rest; rest = static_cast<T>(rest >> 4))
+         {
+            ++length;
+         }
+
+         if(length < format.width) length = format.width;
+      }
+
+      public: auto size() const -> std::size_t { return length; }
+
+      public: auto write(char *out) const -> char * { return format_hex(out, format.value, format.width); }
+
+      private: hex_format<T> format;
+
+      private: unsigned length;
+   };
+
+   // padded values write the fill characters followed by the value's own piece
+   template<typename T>
+   class str_piece<padded<T>>
+   {
+      public: explicit str_piece(padded<T> const &t) : piece(t.value), fill(t.fill), padding(t.width > piece.size() ? t.width - piece.size() : 0) {}
+
+      public: auto size() const -> std::size_t { return padding + piece.size(); }
+
+      public: auto write(char *out) const -> char * { std::memset(out, fill, padding); return piece.write(out + padding); }
+
+      private: str_piece<T> piece;
+
+      private: char fill;
 
-   // append a generic type to an rvalue-std::string
+      private: std::size_t padding;
+   };
+
+   // fixed-point values are measured up front and then written straight into place
+   template<>
+   class str_piece<fixed_format>
+   {
+      public: explicit str_piece(fixed_format const &t) : format(t), length(fixed_size(t.value, t.precision)) {}
+
+      public: auto size() const -> std::size_t { return length; }
+
+      public: auto write(char *out) const -> char * { return format_fixed(out, format.value, format.precision); }
+
+      private: fixed_format format;
+
+      private: std::size_t length;
+   };
+
+   /**
+    * For internal use: make room for 'end' characters and return the buffer to write them to. That is the string itself if it has the capacity;
+    * otherwise the string is copied into 'larger' (grown geometrically, like std::string grows), so that pieces which point into the string stay
+    * valid until they have been written, after which the caller swaps 'larger' into the string.
+    */
+   inline auto append_buffer(std::string &s, std::string &larger, std::size_t end) -> char *
+   {
+      if(end <= s.capacity())
+      {
+         s.resize(end);
+         return &s[0];
+      }
+
+      larger.reserve(std::max(end, 2 * s.capacity()));
+      larger.append(s).resize(end);
+
+      return &larger[0];
+   }
+
+   // terminates the recursion in append(): every piece has been measured, so size the buffer once
+   inline auto append_pieces(std::string &s, std::string &larger, std::size_t end) -> char *
+   {
+      return append_buffer(s, larger, end);
+   }
+
+   // for internal use: measure this piece, size the buffer for the remaining pieces, then write this piece at its offset
+   template<typename T, typename... Ts>
+   auto append_pieces(std::string &s, std::string &larger, std::size_t offset, T const &t, Ts const &... ts) -> char *
+   {
+      str_piece<typename std::decay<T const>::type> const piece(t);
+
+      char *const out = append_pieces(s, larger, offset + piece.size(), ts...);
+
+      piece.write(out + offset);
+
+      return out;
+   }
+
+   // append every argument (which may refer to the string itself) to the string using a single allocation
+   template<typename... Ts>
+   auto append(std::string &s, Ts const &... ts) -> std::string &
+   {
+      std::string larger;
+
+      append_pieces(s, larger, s.size(), ts...);
+
+      if(!larger.empty())
+      {
+         s.swap(larger);
+      }
+
+      return s;
+   }
+
+   // return the concatenation of every argument, built with a single allocation
+   template<typename... Ts>
+   auto concat(Ts const &... ts) -> std::string
+   {
+      std::string s;
+      append(s, ts...);
+      return s;
+   }
+
+   /**
+    * Return the elements of 'range' (of any type supported by append()) with 'separator' between each pair, built with a single allocation: every
+    * piece is measured before anything is written.
+    */
+   template<typename Range, typename Separator>
+   auto join(Range const &range, Separator const &separator) -> std::string
+   {
+      typedef typename std::decay<decltype(*std::begin(range))>::type element_type;
+
+      str_piece<typename std::decay<Separator const>::type> const between(separator);
+
+      std::size_t size = 0;
+      std::size_t count = 0;
+
+      for(auto const &element : range)
+      {
+         size += str_piece<element_type>(element).size();
+         ++count;
+      }
+
+      if(!count)
+      {
+         return {};
+      }
+
+      std::string s(size + (count - 1) * between.size(), '\0');
+      char *out = &s[0];
+      bool first = true;
+
+      for(auto const &element : range)
+      {
+         out = first ? out : between.write(out);
+         out = str_piece<element_type>(element).write(out);
+         first = false;
+      }
+
+      return s;
+   }
+
+   /**
+    * Append 'length' characters at 'text' to the string, escaped for use inside a JSON string (the surrounding quotes are not added): quotation
+    * marks and backslashes are preceded by a backslash, and control characters are written as \n, \r, \t or \u00XX. Other bytes, including UTF-8
+    * sequences, are copied as they are. The text is scanned 16 or 32 bytes at a time (with SSE2 or AVX2, whichever the processor supports) to
+    * measure the result, which is then written with a single allocation.
+    */
+   void append_json_escaped(std::string &s, char const *text, std::size_t length);
+
+   // append a std::string to the string, escaped for use inside a JSON string
+   inline void append_json_escaped(std::string &s, std::string const &text)
+   {
+      append_json_escaped(s, text.data(), text.size());
+   }
+
+   /**
+    * Append 'length' characters at 'text' to the string as one CSV field (RFC 4180): a field containing a comma, a quotation mark, CR or LF is
+    * enclosed in quotation marks, with each quotation mark doubled, and any other field is copied as it is. The text is scanned like
+    * append_json_escaped()'s.
+    */
+   void append_csv_escaped(std::string &s, char const *text, std::size_t length);
+
+   // append a std::string to the string as one CSV field
+   inline void append_csv_escaped(std::string &s, std::string const &text)
+   {
+      append_csv_escaped(s, text.data(), text.size());
+   }
+
+   // append any supported type (numbers and the hex(), pad() and fixed() manipulators) to an rvalue-std::string without a temporary string
    template<typename T> auto operator<<(std::string &&s, T const &t) -> std::string &&
    {
-      return std::move(s += std::to_string(t));
+      return std::move(append(s, t));
    }
 
-   // append a generic type to an lvalue-std::string
+   // append any supported type (numbers and the hex(), pad() and fixed() manipulators) to an lvalue-std::string without a temporary string
    template<typename T> auto operator<<(std::string &s, T const &t) -> std::string &
    {
-      return (s += std::to_string(t));
+      return append(s, t);
+   }
+
+   template<typename Prev, typename T> class str_builder_node;
+
+   /**
+    * Start of an operator<< chain which is measured in full before anything is written, e.g.
+    *
+    *    s << (mdt::str_builder() << "HELLO, C" << '+' << 1 << str);
+    *
+    * Each link only refers to the previous one, so a chain must be consumed within the expression which builds it.
+    */
+   class str_builder
+   {
+      // start a chain with its first piece
+      public: template<typename T> auto operator<<(T const &t) const -> str_builder_node<str_builder, typename std::decay<T const>::type>
+      {
+         return str_builder_node<str_builder, typename std::decay<T const>::type>(*this, t);
+      }
+
+      // the empty start of a chain has no characters
+      public: auto size() const -> std::size_t { return 0; }
+
+      // the empty start of a chain writes nothing
+      public: auto write(char *out) const -> char * { return out; }
+   };
+
+   // one link of an operator<< chain started by str_builder
+   template<typename Prev, typename T>
+   class str_builder_node
+   {
+      // create a link holding one more piece after 'prev'
+      public: str_builder_node(Prev const &prev, T const &t) : prev(prev), piece(t) {}
+
+      // extend the chain with another piece
+      public: template<typename U> auto operator<<(U const &u) const -> str_builder_node<str_builder_node, typename std::decay<U const>::type>
+      {
+         return str_builder_node<str_builder_node, typename std::decay<U const>::type>(*this, u);
+      }
+
+      // return the number of characters in the whole chain up to and including this link
+      public: auto size() const -> std::size_t { return prev.size() + piece.size(); }
+
+      // write the whole chain to 'out' and return the position just past it
+      public: auto write(char *out) const -> char * { return piece.write(prev.write(out)); }
+
+      // return the chain as a new string
+      public: auto str() const -> std::string
+      {
+         std::string s(size(), '\0');
+         write(&s[0]);
+         return s;
+      }
+
+      // allow the chain to initialize a string directly
+      public: operator std::string() const { return str(); }
+
+      private: Prev const &prev;
+
+      private: str_piece<T> const piece;
+   };
+
+   // append a whole str_builder chain (which may refer to the string itself) to an lvalue-std::string using a single allocation
+   template<typename Prev, typename T> auto operator<<(std::string &s, str_builder_node<Prev, T> const &b) -> std::string &
+   {
+      std::string larger;
+
+      std::size_t const offset = s.size();
+      b.write(append_buffer(s, larger, offset + b.size()) + offset);
+
+      if(!larger.empty())
+      {
+         s.swap(larger);
+      }
+
+      return s;
+   }
+
+   // append a whole str_builder chain to an rvalue-std::string using a single allocation
+   template<typename Prev, typename T> auto operator<<(std::string &&s, str_builder_node<Prev, T> const &b) -> std::string &&
+   {
+      return std::move(s << b);
    }
 }
 
@@ -53,5 +500,15 @@ namespace mdt { namespace test { namespace string
 }}}
 #endif
 
+#if defined(MDT_SELF_TEST) || defined(MDT_BENCH)
+#include "../test/bench.hpp"
+
+namespace mdt { namespace bench { namespace string
+{
+   // add the string helper benchmark cases
+   void add_cases(suite &cases);
+}}}
+#endif
+
 
 #endif /* STRING_HPP_ */
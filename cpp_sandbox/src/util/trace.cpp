@@ -0,0 +1,375 @@
+// std::chrono::steady_clock
+#include <chrono>
+
+// uintptr_t
+#include <cstdint>
+
+// std::shared_ptr, std::unique_ptr
+#include <memory>
+
+// std::mutex, std::lock_guard
+#include <mutex>
+
+// std::vector
+#include <vector>
+
+// mdt::trace
+#include "trace.hpp"
+
+// mdt::rope
+#include "rope.hpp"
+
+namespace mdt { namespace trace
+{
+   std::atomic<bool> recording{false};
+
+   // the only source recorded, or nullptr to record every source
+   static std::atomic<void const *> recorded_source{nullptr};
+
+   // one recorded event
+   struct entry
+   {
+      uint64_t time;
+      uint64_t id;
+      void const *source;
+      event kind;
+   };
+
+   // the events of one thread; only that thread writes to it, so publishing an event is a single release store of 'head'
+   struct ring
+   {
+      ring(std::size_t capacity, std::size_t thread) : entries{new entry[capacity]}, mask{capacity - 1}, head{0}, thread{thread} {}
+
+      // the latest events, in order of 'head' modulo the capacity
+      std::unique_ptr<entry[]> entries;
+
+      // capacity minus one
+      std::size_t const mask;
+
+      // number of events ever recorded; the next event goes into entries[head & mask]
+      std::atomic<uint64_t> head;
+
+      // sequence number of the thread, used as its id in the export
+      std::size_t const thread;
+   };
+
+   // owns every thread's ring, so that events outlive the threads which recorded them
+   struct ring_registry
+   {
+      // makes every member thread-safe
+      std::mutex lock;
+
+      // the rings of the current recording
+      std::vector<std::shared_ptr<ring>> rings;
+
+      // capacity of the rings of the current recording
+      std::size_t capacity = 64 * 1024;
+
+      // incremented by start(), so that threads notice that their ring belongs to an earlier recording
+      std::atomic<uint64_t> generation{0};
+
+      // time at which the current recording started
+      uint64_t epoch = 0;
+
+      // sequence number of the next thread to record an event
+      std::size_t threads = 0;
+   };
+
+   // the ring of the calling thread, and the recording it belongs to
+   struct local_ring
+   {
+      std::shared_ptr<ring> events;
+      uint64_t generation;
+   };
+
+   // return the process-wide registry (created on first use)
+   static auto registry() -> ring_registry &
+   {
+      static ring_registry instance;
+      return instance;
+   }
+
+   // return the current time in nanoseconds
+   static auto now() -> uint64_t
+   {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+   }
+
+   void start(std::size_t events_per_thread, void const *only)
+   {
+      auto &r = registry();
+
+      std::lock_guard<std::mutex> lock{r.lock};
+
+      std::size_t capacity = 2;
+
+      while(capacity < events_per_thread)
+      {
+         capacity <<= 1;
+      }
+
+      // threads still holding rings of the previous recording register new ones on their next event
+      r.rings.clear();
+      r.capacity = capacity;
+      r.epoch = now();
+      r.threads = 0;
+      r.generation.fetch_add(1, std::memory_order_release);
+
+      recorded_source.store(only, std::memory_order_relaxed);
+      recording.store(true, std::memory_order_relaxed);
+   }
+
+   void stop()
+   {
+      recording.store(false, std::memory_order_relaxed);
+   }
+
+   void record_slow(event kind, void const *source, uint64_t id)
+   {
+      void const *const only = recorded_source.load(std::memory_order_relaxed);
+
+      if(only && only != source)
+      {
+         return;
+      }
+
+      auto &r = registry();
+
+      static thread_local local_ring local{nullptr, 0};
+
+      // the first event of a thread (in each recording) registers a ring for it
+      if(!local.events || local.generation != r.generation.load(std::memory_order_acquire))
+      {
+         std::lock_guard<std::mutex> lock{r.lock};
+
+         local.events = std::make_shared<ring>(r.capacity, r.threads++);
+         local.generation = r.generation.load(std::memory_order_relaxed);
+
+         r.rings.push_back(local.events);
+      }
+
+      ring &events = *local.events;
+      uint64_t const head = events.head.load(std::memory_order_relaxed);
+
+      events.entries[head & events.mask] = entry{now(), id, source, kind};
+      events.head.store(head + 1, std::memory_order_release);
+   }
+
+   // append the parts common to every exported event
+   static void append_event(mdt::rope &output, char const *name, char const *phase, entry const &e, uint64_t epoch, std::size_t thread)
+   {
+      output << "{\"name\":\"" << name << "\",\"cat\":\"queue\",\"ph\":\"" << phase << "\",\"ts\":"
+             << mdt::fixed(static_cast<double>(e.time - epoch) / 1000, 3) << ",\"pid\":1,\"tid\":" << thread;
+   }
+
+   // append the identifier shared by an element's enqueue and dequeue events
+   static void append_element(mdt::rope &output, entry const &e)
+   {
+      output << "\"0x" << mdt::hex(reinterpret_cast<uintptr_t>(e.source)) << ':' << e.id << '"';
+   }
+
+   auto chrome_json(void const *source) -> mdt::rope
+   {
+      auto &r = registry();
+
+      std::vector<std::shared_ptr<ring>> rings;
+      uint64_t epoch;
+
+      {
+         std::lock_guard<std::mutex> lock{r.lock};
+
+         rings = r.rings;
+         epoch = r.epoch;
+      }
+
+      mdt::rope output;
+      bool first = true;
+
+      // start each event on its own line, separated by commas
+      auto next = [&output, &first]
+      {
+         output << (first ? "" : ",\n");
+         first = false;
+      };
+
+      output << "{\"traceEvents\":[\n";
+
+      for(auto const &events : rings)
+      {
+         uint64_t const head = events->head.load(std::memory_order_acquire);
+         uint64_t const capacity = events->mask + 1;
+         bool named = false;
+
+         for(uint64_t i = head > capacity ? head - capacity : 0; i < head; ++i)
+         {
+            entry const &e = events->entries[i & events->mask];
+
+            if(source && e.source != source)
+            {
+               continue;
+            }
+
+            // name the thread before its first event
+            if(!named)
+            {
+               next();
+               output << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << events->thread << ",\"args\":{\"name\":\"thread "
+                      << events->thread << "\"}}";
+               named = true;
+            }
+
+            next();
+
+            switch(e.kind)
+            {
+               case event::enqueue:
+                  append_event(output, "queued", "b", e, epoch, events->thread);
+                  output << ",\"id\":";
+                  append_element(output, e);
+                  output << '}';
+                  break;
+
+               case event::dequeue:
+                  append_event(output, "queued", "e", e, epoch, events->thread);
+                  output << ",\"id\":";
+                  append_element(output, e);
+                  output << '}';
+                  break;
+
+               case event::callback_begin:
+                  append_event(output, "callback", "B", e, epoch, events->thread);
+                  output << ",\"args\":{\"element\":";
+                  append_element(output, e);
+                  output << "}}";
+                  break;
+
+               case event::callback_end:
+                  append_event(output, "callback", "E", e, epoch, events->thread);
+                  output << '}';
+                  break;
+
+               case event::pause:
+               case event::resume:
+                  append_event(output, e.kind == event::pause ? "pause" : "resume", "i", e, epoch, events->thread);
+                  output << ",\"s\":\"t\",\"args\":{\"queue\":\"0x" << mdt::hex(reinterpret_cast<uintptr_t>(e.source)) << "\"}}";
+                  break;
+            }
+         }
+      }
+
+      output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+      return output;
+   }
+}}
+
+#ifdef MDT_SELF_TEST
+
+// std::string
+#include <string>
+
+// mdt::pending_queue
+#include "pending_queue.hpp"
+
+namespace mdt { namespace test { namespace trace
+{
+   // return the number of times 'needle' occurs in 'haystack'
+   static auto occurrences(std::string const &haystack, std::string const &needle) -> std::size_t
+   {
+      std::size_t count = 0;
+
+      for(auto i = haystack.find(needle); i != std::string::npos; i = haystack.find(needle, i + 1))
+      {
+         ++count;
+      }
+
+      return count;
+   }
+
+   auto all() -> result
+   {
+      // explicitly specify this operator so that compiler can find it
+      using mdt::operator<<;
+
+      test::result result{"trace tests"};
+
+      /**
+       * (1) Ensure that nothing is recorded while tracing is stopped.
+       */
+      {
+         int const source = 0;
+
+         mdt::trace::start(64, &source);
+         mdt::trace::stop();
+         mdt::trace::record(mdt::trace::event::enqueue, &source, 1);
+
+         result << test::result{"stopped -> nothing recorded", mdt::trace::chrome_json(&source).to_string() == "{\"traceEvents\":[\n\n],\"displayTimeUnit\":\"ns\"}\n"};
+      }
+
+      /**
+       * (2) Ensure that every stage of each element's trip through a pending_queue is exported, paired by element id, and that only the traced
+       *     queue is recorded.
+       */
+      {
+         std::size_t processed = 0;
+         mdt::pending_queue<int> q([&processed](int){ ++processed; });
+
+         mdt::trace::start(1024, &q);
+
+         {
+            // start the queue thread
+            local(q.go());
+
+            q.pause();
+
+            for(int i = 0; i < 10; ++i)
+            {
+               q.add(i);
+            }
+
+            q.pause(false);
+            q.sync();
+
+            // end the queue thread
+         }
+
+         mdt::trace::stop();
+
+         std::string const json = mdt::trace::chrome_json(&q).to_string();
+         result << test::result
+         {
+            "enqueue/dequeue -> queued spans",
+            occurrences(json, "\"ph\":\"b\"") == 10 && occurrences(json, "\"ph\":\"e\"") == 10 && occurrences(json, ":9\"") == 3
+         };
+
+         result << test::result{"call-backs -> callback spans", processed == 10 && occurrences(json, "\"ph\":\"B\"") == 10 && occurrences(json, "\"ph\":\"E\"") == 10};
+         result << test::result{"pause/resume -> instant events", occurrences(json, "\"name\":\"pause\"") == 1 && occurrences(json, "\"name\":\"resume\"") == 1};
+         result << test::result{"two threads -> two named threads", occurrences(json, "\"thread_name\"") == 2};
+         result << test::result{"other sources -> not recorded", mdt::trace::chrome_json().to_string() == json};
+      }
+
+      /**
+       * (3) Ensure that a full ring keeps the latest events.
+       */
+      {
+         int const source = 0;
+
+         mdt::trace::start(8, &source);
+
+         for(uint64_t i = 0; i < 20; ++i)
+         {
+            mdt::trace::record(mdt::trace::event::enqueue, &source, i);
+         }
+
+         mdt::trace::stop();
+
+         std::string const json = mdt::trace::chrome_json(&source).to_string();
+
+         result << test::result{"full ring -> latest events kept", occurrences(json, "\"ph\":\"b\"") == 8 && occurrences(json, ":12\"") == 1 && !occurrences(json, ":11\"")};
+      }
+
+      return result;
+   }
+}}}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+// std::atomic
+#include <atomic>
+
+// std::size_t
+#include <cstddef>
+
+// uint64_t, uint8_t
+#include <cstdint>
+
+namespace mdt
+{
+   class rope;
+}
+
+namespace mdt { namespace trace
+{
+   // kinds of events recorded for a queue and its elements
+   enum class event : uint8_t
+   {
+      enqueue,          // an element was added to the queue
+      dequeue,          // an element was taken off the queue to be processed
+      callback_begin,   // the call-back started processing an element
+      callback_end,     // the call-back finished processing an element
+      pause,            // the queue was paused
+      resume            // the queue was un-paused
+   };
+
+   // for internal use: true while events are being recorded
+   extern std::atomic<bool> recording;
+
+   // return true while events are being recorded; this is all that an instrumented code path costs while tracing is stopped
+   inline auto active() -> bool
+   {
+      return recording.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * Discard every recorded event and start recording, keeping the latest 'events_per_thread' (rounded up to a power of two) of each thread.
+    * If 'only' is not nullptr, events of other sources are ignored, so that tracing one queue does not disturb the rest of the process.
+    */
+   void start(std::size_t events_per_thread = 64 * 1024, void const *only = nullptr);
+
+   // stop recording; the recorded events are kept until the next start()
+   void stop();
+
+   // for internal use: record an event, whether or not recording (see record())
+   void record_slow(event kind, void const *source, uint64_t id);
+
+   // record an event for 'source' (e.g., a queue) and the element 'id' on the calling thread's ring buffer, if recording
+   inline void record(event kind, void const *source, uint64_t id = 0)
+   {
+      if(active())
+      {
+         record_slow(kind, source, id);
+      }
+   }
+
+   /**
+    * Return the recorded events (only those of 'source', unless it is nullptr) in Chrome trace event format, which can be loaded into
+    * chrome://tracing or Perfetto. Each element's enqueue and dequeue become an asynchronous "queued" span, so the timeline shows how long every
+    * element waited; each call-back becomes a "callback" span on the thread which ran it; pauses and resumptions become instant events. Threads
+    * which are still recording may overwrite the oldest events while they are read, so export once the traced work has finished.
+    */
+   auto chrome_json(void const *source = nullptr) -> mdt::rope;
+}}
+
+#ifdef MDT_SELF_TEST
+#include "../test/results.hpp"
+
+namespace mdt { namespace test { namespace trace
+{
+   // run all trace tests
+   auto all() -> result;
+}}}
+#endif
+
+#endif /* TRACE_HPP_ */